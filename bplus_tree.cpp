@@ -0,0 +1,586 @@
+/*═══════════════════════════════════════════════════════════════════════════════
+ * CONCURRENT B+TREE - Optimistic Lock Coupling, Cache-Line Nodes, SIMD Search
+ *═══════════════════════════════════════════════════════════════════════════════
+ *
+ * OVERVIEW:
+ * An alternative engine to rbt::RBTree with the same lookup / insert /
+ * erase / validate interface, so the stress harness and the benchmark
+ * suite can drive either. A red-black tree costs one cache miss per level
+ * (one key per node); a B+tree node packs tens of keys into a few cache
+ * lines, cutting the height from ~2·log2(n) to ~log_F(n) levels.
+ *
+ * NODE LAYOUT (64-byte aligned, at most NODE_BYTES = 512, i.e. 8 cache lines):
+ *
+ *   Inner: │ version │ count │ keys[INNER_CAP]          │ children[INNER_CAP+1] │
+ *   Leaf : │ version │ count │ keys[LEAF_CAP]           │ vals[LEAF_CAP]        │
+ *
+ * Capacities round down to whole 64-byte chunks of keys, so nodes usually
+ * come out below the budget: for <int, int> a leaf holds 48 keys and an
+ * inner node 32, both 448 bytes (7 lines).
+ *
+ * Keys are a dense sorted array, so the in-node search for signed 32/64-bit
+ * keys under std::less is a handful of AVX2/SSE2 compares + popcount
+ * instead of a branchy binary search. Other key types use std::lower_bound.
+ *
+ * CONCURRENCY: Optimistic Lock Coupling (Leis et al., DaMoN 2016)
+ * - Every node carries a version word; bit 1 = write-locked.
+ * - Readers never write shared memory: they read a node's version, read
+ *   the node, and re-check the version before trusting what they read
+ *   (and before moving to the child). Any mismatch restarts from the root.
+ * - Writers descend the same way and upgrade only the node(s) they modify
+ *   (leaf, plus the parent when splitting) with a CAS on the version they
+ *   validated. Full nodes are split eagerly on the way down, so a split
+ *   never propagates more than one level.
+ *
+ * MEMORY RECLAMATION: erase() removes the key from its leaf but never
+ * merges or frees nodes, and splits only ever add nodes. A node reachable
+ * by an optimistic reader is therefore never freed while the tree is alive
+ * and no epoch scheme is needed. Empty leaves are reused by later inserts.
+ *
+ * REQUIREMENTS: K and V trivially copyable (optimistic readers copy them
+ * before validating), Compare a strict weak ordering.
+ *═══════════════════════════════════════════════════════════════════════════════*/
+
+// Build & run the demo:
+// g++ -std=c++17 -O2 -DRBTREE_DEMO bplus_tree.cpp -o bplus_tree -pthread
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <thread>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace rbt
+{
+    template <typename K, typename V, typename Compare = std::less<K>>
+    class BPlusTree
+    {
+        static_assert(std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V>,
+                      "optimistic readers copy keys/values before validating");
+
+    public:
+        static constexpr size_t NODE_BYTES = 512;
+
+    private:
+        /*═══════════════════════════════════════════════════════════════════════
+         * NODES
+         *═══════════════════════════════════════════════════════════════════════*/
+        struct alignas(64) NodeBase
+        {
+            std::atomic<uint64_t> version{0};   // Bit 1: locked; += 2 per lock/unlock
+            uint16_t count = 0;                 // Keys in use
+            bool is_leaf;
+
+            explicit NodeBase(bool leaf) : is_leaf(leaf) {}
+        };
+
+        // alignas(64) pads NodeBase to a full line. Itanium-ABI compilers put
+        // Leaf / Inner members in that tail padding, MSVC does not; budgeting
+        // the whole line keeps every node within NODE_BYTES on both.
+        static constexpr size_t HEADER_BYTES = sizeof(NodeBase);
+        static constexpr size_t LANES = 64 / sizeof(K) ? 64 / sizeof(K) : 1;   // SIMD chunking unit
+
+        // Capacities rounded down to whole SIMD chunks so vector loads stay in bounds
+        static constexpr size_t round_lanes(size_t n) { return n >= LANES ? n / LANES * LANES : n; }
+
+    public:
+        static constexpr size_t LEAF_CAP = round_lanes((NODE_BYTES - HEADER_BYTES) / (sizeof(K) + sizeof(V)));
+        static constexpr size_t INNER_CAP = round_lanes((NODE_BYTES - HEADER_BYTES - sizeof(void *)) /
+                                                        (sizeof(K) + sizeof(void *)));
+        static_assert(LEAF_CAP >= 4 && INNER_CAP >= 4, "keys too large for NODE_BYTES");
+
+    private:
+        struct Leaf : NodeBase
+        {
+            K keys[LEAF_CAP];
+            V vals[LEAF_CAP];
+            Leaf() : NodeBase(true) {}
+        };
+
+        struct Inner : NodeBase
+        {
+            K keys[INNER_CAP];                  // keys[i] >= every key under children[i]
+            NodeBase *children[INNER_CAP + 1];
+            Inner() : NodeBase(false) {}
+        };
+        static_assert(sizeof(Leaf) <= NODE_BYTES && sizeof(Inner) <= NODE_BYTES, "node exceeds NODE_BYTES");
+
+    public:
+        BPlusTree() : root(new Leaf()) {}
+
+        ~BPlusTree() { destroy(root.load(std::memory_order_relaxed)); }
+
+        BPlusTree(const BPlusTree &) = delete;
+        BPlusTree &operator=(const BPlusTree &) = delete;
+
+        /*═══════════════════════════════════════════════════════════════════════
+         * LOOKUP - Lock-Free Optimistic Descent
+         *═══════════════════════════════════════════════════════════════════════*/
+        std::optional<V> lookup(const K &k) const
+        {
+            for (;;)
+            {
+                bool restart = false;
+                NodeBase *node = root.load(std::memory_order_acquire);
+                uint64_t v = read_lock(node);
+                if (node != root.load(std::memory_order_acquire)) continue;
+
+                while (!node->is_leaf)
+                {
+                    auto *inner = static_cast<Inner *>(node);
+                    NodeBase *child = inner->children[child_index(inner, k)];
+                    if (!validate_version(inner, v)) { restart = true; break; }
+                    node = child;
+                    v = read_lock(node);
+                }
+                if (restart) continue;
+
+                auto *leaf = static_cast<Leaf *>(node);
+                size_t pos = position(leaf->keys, leaf_count(leaf), k);
+                bool found = pos < leaf_count(leaf) && !comp(k, leaf->keys[pos]);
+                V val{};
+                if (found) val = leaf->vals[pos];
+                if (!validate_version(leaf, v)) continue;
+                if (found) return val;
+                return std::nullopt;
+            }
+        }
+
+        /*═══════════════════════════════════════════════════════════════════════
+         * INSERT - Optimistic Descent, Eager Split, Leaf-Only Write Lock
+         *═══════════════════════════════════════════════════════════════════════
+         * Inserts k or overwrites its value. A full node met on the way down
+         * is split under write locks on it and its parent, then the whole
+         * operation restarts (the paper's "restart after split" variant).
+         *═══════════════════════════════════════════════════════════════════════*/
+        void insert(const K &k, const V &val)
+        {
+            for (;;)
+            {
+                bool restart = false;
+                NodeBase *node = root.load(std::memory_order_acquire);
+                uint64_t v = read_lock(node);
+                if (node != root.load(std::memory_order_acquire)) continue;
+
+                Inner *parent = nullptr;
+                uint64_t pv = 0;
+
+                while (!node->is_leaf)
+                {
+                    auto *inner = static_cast<Inner *>(node);
+                    if (inner->count == INNER_CAP)
+                    {
+                        split_and_unlock(parent, pv, node, v);
+                        restart = true;
+                        break;
+                    }
+                    if (parent && !validate_version(parent, pv)) { restart = true; break; }
+
+                    parent = inner;
+                    pv = v;
+                    node = inner->children[child_index(inner, k)];
+                    if (!validate_version(inner, v)) { restart = true; break; }
+                    v = read_lock(node);
+                }
+                if (restart) continue;
+
+                auto *leaf = static_cast<Leaf *>(node);
+                if (leaf->count == LEAF_CAP)
+                {
+                    split_and_unlock(parent, pv, node, v);
+                    continue;
+                }
+                if (!upgrade(leaf, v)) continue;
+                if (parent && !validate_version(parent, pv))
+                {
+                    write_unlock(leaf);
+                    continue;
+                }
+
+                size_t pos = position(leaf->keys, leaf->count, k);
+                if (pos < leaf->count && !comp(k, leaf->keys[pos]))
+                {
+                    leaf->vals[pos] = val;              // Existing key: overwrite
+                }
+                else
+                {
+                    std::memmove(leaf->keys + pos + 1, leaf->keys + pos, (leaf->count - pos) * sizeof(K));
+                    std::memmove(leaf->vals + pos + 1, leaf->vals + pos, (leaf->count - pos) * sizeof(V));
+                    leaf->keys[pos] = k;
+                    leaf->vals[pos] = val;
+                    leaf->count++;
+                }
+                write_unlock(leaf);
+                return;
+            }
+        }
+
+        /*═══════════════════════════════════════════════════════════════════════
+         * ERASE - Remove from Leaf (No Merging)
+         *═══════════════════════════════════════════════════════════════════════*/
+        bool erase(const K &k)
+        {
+            for (;;)
+            {
+                bool restart = false;
+                NodeBase *node = root.load(std::memory_order_acquire);
+                uint64_t v = read_lock(node);
+                if (node != root.load(std::memory_order_acquire)) continue;
+
+                Inner *parent = nullptr;
+                uint64_t pv = 0;
+
+                while (!node->is_leaf)
+                {
+                    auto *inner = static_cast<Inner *>(node);
+                    if (parent && !validate_version(parent, pv)) { restart = true; break; }
+                    parent = inner;
+                    pv = v;
+                    node = inner->children[child_index(inner, k)];
+                    if (!validate_version(inner, v)) { restart = true; break; }
+                    v = read_lock(node);
+                }
+                if (restart) continue;
+
+                auto *leaf = static_cast<Leaf *>(node);
+                size_t pos = position(leaf->keys, leaf_count(leaf), k);
+                bool found = pos < leaf_count(leaf) && !comp(k, leaf->keys[pos]);
+                if (!found)
+                {
+                    if (!validate_version(leaf, v)) continue;
+                    return false;                   // Validated miss: no lock taken
+                }
+
+                if (!upgrade(leaf, v)) continue;
+                if (parent && !validate_version(parent, pv))
+                {
+                    write_unlock(leaf);
+                    continue;
+                }
+                std::memmove(leaf->keys + pos, leaf->keys + pos + 1, (leaf->count - pos - 1) * sizeof(K));
+                std::memmove(leaf->vals + pos, leaf->vals + pos + 1, (leaf->count - pos - 1) * sizeof(V));
+                leaf->count--;
+                write_unlock(leaf);
+                return true;
+            }
+        }
+
+        /*═══════════════════════════════════════════════════════════════════════
+         * VALIDATION - Structural Invariants (call while no writer is active)
+         *═══════════════════════════════════════════════════════════════════════
+         * 1. Keys sorted strictly ascending within each node
+         * 2. Every key lies inside the (lo, hi] range implied by its parents
+         * 3. All leaves at the same depth
+         * 4. Counts within capacity, no node left locked
+         *═══════════════════════════════════════════════════════════════════════*/
+        bool validate() const
+        {
+            int leaf_depth = -1;
+            return validate_rec(root.load(std::memory_order_acquire), nullptr, nullptr, 0, leaf_depth);
+        }
+
+    private:
+        std::atomic<NodeBase *> root;
+        Compare comp;
+
+        /*───────────────────────────────────────────────────────────────────────
+         * Version word helpers (seqlock-style)
+         *───────────────────────────────────────────────────────────────────────*/
+        static constexpr uint64_t LOCKED = 0b10;
+
+        // Wait until n is unlocked and return its version
+        static uint64_t read_lock(const NodeBase *n)
+        {
+            for (int spins = 0;; ++spins)
+            {
+                uint64_t v = n->version.load(std::memory_order_acquire);
+                if (!(v & LOCKED)) return v;
+                if (spins > 64) std::this_thread::yield();
+            }
+        }
+
+        // True if nothing was written to n since its version was v
+        static bool validate_version(const NodeBase *n, uint64_t v)
+        {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return n->version.load(std::memory_order_relaxed) == v;
+        }
+
+        static bool upgrade(NodeBase *n, uint64_t v)
+        {
+            return n->version.compare_exchange_strong(v, v + LOCKED, std::memory_order_acquire);
+        }
+
+        static void write_unlock(NodeBase *n)
+        {
+            n->version.fetch_add(LOCKED, std::memory_order_release);
+        }
+
+        // Racy reads may see a torn count; never index past capacity
+        static size_t leaf_count(const Leaf *l) { return std::min<size_t>(l->count, LEAF_CAP); }
+        static size_t inner_count(const Inner *i) { return std::min<size_t>(i->count, INNER_CAP); }
+
+        size_t child_index(const Inner *inner, const K &k) const
+        {
+            return position(inner->keys, inner_count(inner), k);
+        }
+
+        /*───────────────────────────────────────────────────────────────────────
+         * position - number of keys[0..n) strictly less than x (= lower_bound)
+         *───────────────────────────────────────────────────────────────────────
+         * Signed 32/64-bit keys under std::less compare a whole chunk per
+         * instruction; lanes at index >= n are masked out of the popcount.
+         *───────────────────────────────────────────────────────────────────────*/
+        size_t position(const K *keys, size_t n, const K &x) const
+        {
+            constexpr bool SIMD_KEY = std::is_same_v<Compare, std::less<K>> && std::is_integral_v<K> &&
+                                      std::is_signed_v<K> && (sizeof(K) == 4 || sizeof(K) == 8);
+            if constexpr (SIMD_KEY)
+            {
+#if defined(__AVX2__)
+                size_t c = 0;
+                for (size_t i = 0; i < n; i += 32 / sizeof(K))
+                {
+                    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+                    unsigned m;
+                    if constexpr (sizeof(K) == 4)
+                        m = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(
+                            _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int32_t>(x)), a))));
+                    else
+                        m = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(
+                            _mm256_cmpgt_epi64(_mm256_set1_epi64x(static_cast<int64_t>(x)), a))));
+                    size_t live = std::min<size_t>(32 / sizeof(K), n - i);
+                    c += static_cast<size_t>(__builtin_popcount(m & ((1u << live) - 1)));
+                }
+                return c;
+#elif defined(__SSE2__)
+                if constexpr (sizeof(K) == 4)
+                {
+                    size_t c = 0;
+                    __m128i v = _mm_set1_epi32(static_cast<int32_t>(x));
+                    for (size_t i = 0; i < n; i += 4)
+                    {
+                        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i));
+                        unsigned m = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(v, a))));
+                        size_t live = std::min<size_t>(4, n - i);
+                        c += static_cast<size_t>(__builtin_popcount(m & ((1u << live) - 1)));
+                    }
+                    return c;
+                }
+#endif
+            }
+            return static_cast<size_t>(std::lower_bound(keys, keys + n, x, comp) - keys);
+        }
+
+        /*───────────────────────────────────────────────────────────────────────
+         * split_and_unlock - split full node (child of parent), then unlock
+         *───────────────────────────────────────────────────────────────────────
+         * Locks parent (if any) then node at their validated versions; if
+         * either moved on, gives up and the caller restarts. A split root is
+         * replaced by a new inner root holding the two halves.
+         *───────────────────────────────────────────────────────────────────────*/
+        void split_and_unlock(Inner *parent, uint64_t pv, NodeBase *node, uint64_t v)
+        {
+            if (parent && !upgrade(parent, pv)) return;
+            if (!upgrade(node, v))
+            {
+                if (parent) write_unlock(parent);
+                return;
+            }
+            if (!parent && node != root.load(std::memory_order_relaxed))
+            {
+                write_unlock(node);                 // Root changed under us
+                return;
+            }
+
+            K sep;
+            NodeBase *right;
+            if (node->is_leaf)
+            {
+                auto *l = static_cast<Leaf *>(node);
+                auto *r = new Leaf();
+                size_t keep = l->count / 2;
+                r->count = static_cast<uint16_t>(l->count - keep);
+                std::memcpy(r->keys, l->keys + keep, r->count * sizeof(K));
+                std::memcpy(r->vals, l->vals + keep, r->count * sizeof(V));
+                l->count = static_cast<uint16_t>(keep);
+                sep = l->keys[keep - 1];
+                right = r;
+            }
+            else
+            {
+                auto *in = static_cast<Inner *>(node);
+                auto *r = new Inner();
+                size_t m = in->count / 2;           // keys[m] moves up
+                r->count = static_cast<uint16_t>(in->count - m - 1);
+                std::memcpy(r->keys, in->keys + m + 1, r->count * sizeof(K));
+                std::memcpy(r->children, in->children + m + 1, (r->count + 1) * sizeof(NodeBase *));
+                sep = in->keys[m];
+                in->count = static_cast<uint16_t>(m);
+                right = r;
+            }
+
+            if (parent)
+            {
+                size_t pos = position(parent->keys, parent->count, sep);
+                std::memmove(parent->keys + pos + 1, parent->keys + pos, (parent->count - pos) * sizeof(K));
+                std::memmove(parent->children + pos + 2, parent->children + pos + 1,
+                             (parent->count - pos) * sizeof(NodeBase *));
+                parent->keys[pos] = sep;
+                parent->children[pos + 1] = right;
+                parent->count++;
+            }
+            else
+            {
+                auto *new_root = new Inner();
+                new_root->count = 1;
+                new_root->keys[0] = sep;
+                new_root->children[0] = node;
+                new_root->children[1] = right;
+                root.store(new_root, std::memory_order_release);
+            }
+
+            write_unlock(node);
+            if (parent) write_unlock(parent);
+        }
+
+        bool validate_rec(const NodeBase *n, const K *lo, const K *hi, int depth, int &leaf_depth) const
+        {
+            if (n->version.load(std::memory_order_relaxed) & LOCKED) return false;
+
+            const K *keys;
+            size_t count = n->count;
+            if (n->is_leaf)
+            {
+                if (count > LEAF_CAP) return false;
+                keys = static_cast<const Leaf *>(n)->keys;
+            }
+            else
+            {
+                if (count == 0 || count > INNER_CAP) return false;
+                keys = static_cast<const Inner *>(n)->keys;
+            }
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (i > 0 && !comp(keys[i - 1], keys[i])) return false;   // Sorted, unique
+                if (lo && !comp(*lo, keys[i])) return false;              // > lower separator
+                if (hi && comp(*hi, keys[i])) return false;               // <= upper separator
+            }
+
+            if (n->is_leaf)
+            {
+                if (leaf_depth == -1) leaf_depth = depth;
+                return leaf_depth == depth;
+            }
+
+            auto *in = static_cast<const Inner *>(n);
+            for (size_t i = 0; i <= count; ++i)
+            {
+                const K *clo = i == 0 ? lo : &keys[i - 1];
+                const K *chi = i == count ? hi : &keys[i];
+                if (!validate_rec(in->children[i], clo, chi, depth + 1, leaf_depth)) return false;
+            }
+            return true;
+        }
+
+        void destroy(NodeBase *n)
+        {
+            if (n->is_leaf)
+            {
+                delete static_cast<Leaf *>(n);
+                return;
+            }
+            auto *in = static_cast<Inner *>(n);
+            for (size_t i = 0; i <= in->count; ++i)
+                destroy(in->children[i]);
+            delete in;
+        }
+    };
+
+} // namespace rbt
+
+#ifdef RBTREE_DEMO
+/*═══════════════════════════════════════════════════════════════════════════════
+ * DEMO - Concurrent Readers/Writers Against a std::map Model
+ *═══════════════════════════════════════════════════════════════════════════════
+ * Writers own disjoint key ranges, so each can keep an exact model of its
+ * range; readers run lookups across all ranges meanwhile.
+ *═══════════════════════════════════════════════════════════════════════════════*/
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+int main()
+{
+    constexpr int WRITERS = 4;
+    constexpr int READERS = 4;
+    constexpr int OPS = 200000;
+    constexpr int RANGE = 20000;
+
+    rbt::BPlusTree<int, int> tree;
+    std::cout << "BPlusTree<int,int>: LEAF_CAP=" << rbt::BPlusTree<int, int>::LEAF_CAP
+              << ", INNER_CAP=" << rbt::BPlusTree<int, int>::INNER_CAP << "\n";
+
+    std::vector<std::map<int, int>> model(WRITERS);
+    std::atomic<bool> stop{false};
+    std::atomic<long> reads{0};
+    std::vector<std::thread> writers, readers;
+
+    for (int w = 0; w < WRITERS; ++w)
+        writers.emplace_back([&, w] {
+            std::mt19937 rng(w + 1);
+            for (int i = 0; i < OPS; ++i)
+            {
+                int k = w * RANGE + static_cast<int>(rng() % RANGE);
+                if (rng() % 3)
+                {
+                    tree.insert(k, i);
+                    model[w][k] = i;
+                }
+                else if (tree.erase(k) != (model[w].erase(k) > 0))
+                {
+                    std::cerr << "erase result mismatch at " << k << "\n";
+                    std::abort();
+                }
+            }
+        });
+    for (int r = 0; r < READERS; ++r)
+        readers.emplace_back([&, r] {
+            std::mt19937 rng(100 + r);
+            long n = 0;
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                tree.lookup(static_cast<int>(rng() % (WRITERS * RANGE)));
+                ++n;
+            }
+            reads += n;
+        });
+
+    for (auto &t : writers) t.join();
+    stop = true;
+    for (auto &t : readers) t.join();
+
+    bool ok = tree.validate();
+    for (int w = 0; w < WRITERS && ok; ++w)
+        for (int k = w * RANGE; k < (w + 1) * RANGE && ok; ++k)
+        {
+            auto it = model[w].find(k);
+            auto got = tree.lookup(k);
+            ok = (it == model[w].end()) ? !got : (got && *got == it->second);
+        }
+
+    std::cout << WRITERS * OPS << " writes, " << reads << " concurrent reads\n"
+              << (ok ? "B+tree valid and matches model ✔" : "B+tree check FAILED ✘") << "\n";
+    return ok ? 0 : 1;
+}
+#endif // RBTREE_DEMO
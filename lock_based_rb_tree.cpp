@@ -10,7 +10,9 @@
  *
  * KEY DESIGN PRINCIPLES:
  * 1. **Writer Serialization**: All writers (insert/delete) are serialized via
- *    a global mutex to avoid complex writer-writer coordination.
+ *    a global mutex to avoid complex writer-writer coordination. Writers
+ *    search optimistically (version-validated) before taking it, so the
+ *    mutex only covers the relink and rebalancing.
  * 2. **Multiple Reader Strategies**: Provides three different approaches for
  *    handling concurrent reads with different performance characteristics.
  * 3. **Deadlock Prevention**: Uses ordered lock acquisition and other techniques
@@ -44,23 +46,60 @@
  * - Uses std::shared_mutex for reader-writer coordination
  * - Multiple readers can proceed concurrently  
  * - Pros: Good reader parallelism, simple
- * - Cons: Potential reader starvation of writers
+ * - Cons: Potential reader starvation of writers (std::shared_mutex); pass
+ *   PhaseFairRWLock as the RWLock policy to bound writer wait
  * - Best for: Read-dominated workloads
  *
  *═══════════════════════════════════════════════════════════════════════════════*/
 
  #include <algorithm>
+ #include <array>
+ #include <atomic>
  #include <cassert>
+ #include <cerrno>
  #include <chrono>
+ #include <cmath>
+ #include <cstddef>
+ #include <cstdint>
+ #include <cstdio>
+ #include <cstring>
+ #include <functional>
+ #include <iomanip>
  #include <iostream>
+ #include <limits>
+ #include <memory>
+ #include <new>
  #include <mutex>
  #include <numeric>
  #include <optional>
  #include <random>
  #include <shared_mutex>
+ #include <string>
+ #include <string_view>
  #include <thread>
+ #include <type_traits>
+ #include <utility>
  #include <vector>
  
+ // C++20 operator<=> for single-comparison descents (RBTree::three_way)
+ #if __cplusplus >= 202002L
+ #include <compare>
+ #endif
+ 
+ // x86 SIMD key search in EytzingerTree (scalar fallback elsewhere)
+ #if defined(__AVX2__) || defined(__SSE2__)
+ #include <immintrin.h>
+ #endif
+ 
+ // Snapshot save / mmap open (save_snapshot, FrozenTree) need POSIX file APIs
+ #if defined(__unix__) || defined(__APPLE__)
+ #define RBT_HAVE_MMAP 1
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+ #endif
+ 
  namespace rbt
  {
      /*═══════════════════════════════════════════════════════════════════════════
@@ -86,14 +125,57 @@
       * - RB-tree color for balancing
       * - Per-node shared_mutex for fine-grained locking
       * - Unique lock_id for deadlock prevention (ordered acquisition)
+      * - Structure version for optimistic (lock-free) writer descents
+      * - For std::string keys, the key's first 8 bytes inline (NodeKeyPrefix)
       *
       * LOCKING SEMANTICS:
       * - shared_lock: Multiple readers can hold simultaneously
       * - unique_lock: Exclusive access for modifications
       * - Lock coupling: Acquire child lock before releasing parent lock
+      *
+      * VERSION SEMANTICS (seqlock style, written only under writers_mutex):
+      * - Even: left/right links stable since the value was read
+      * - Odd:  a writer is relinking this node right now
+      * - Left odd forever once the node is erased (obsolete)
       *═══════════════════════════════════════════════════════════════════════════*/
+     /*───────────────────────────────────────────────────────────────────────────
+      * NodeKeyPrefix - Inline Prefix of std::string Keys
+      *───────────────────────────────────────────────────────────────────────────
+      * Comparing against a std::string key reads its heap buffer: one more
+      * cache miss per level on top of the node itself. String nodes therefore
+      * carry the key's first 8 bytes big-endian, zero-padded. Under the char
+      * order std::less<std::string> uses, prefix(a) < prefix(b) implies a < b,
+      * so a descent only touches the key buffer when the prefixes tie (see
+      * RBTree::prefix_order). Other key types carry nothing (empty base).
+      *───────────────────────────────────────────────────────────────────────────*/
+     inline uint64_t string_prefix(std::string_view s)
+     {
+         unsigned char bytes[8] = {};
+         if (s.size() >= sizeof(bytes))
+             std::memcpy(bytes, s.data(), sizeof(bytes));    // Fixed size: a single load
+         else
+             std::memcpy(bytes, s.data(), s.size());
+         uint64_t p = 0;
+         for (unsigned char b : bytes)
+             p = (p << 8) | b;               // Big-endian: integer order == byte order
+         return p;
+     }
+ 
+     template <typename K>
+     struct NodeKeyPrefix
+     {
+         explicit NodeKeyPrefix(const K &) {}
+     };
+ 
+     template <>
+     struct NodeKeyPrefix<std::string>
+     {
+         const uint64_t prefix;           // string_prefix(key)
+         explicit NodeKeyPrefix(const std::string &k) : prefix(string_prefix(k)) {}
+     };
+ 
      template <typename K, typename V>
-     struct Node
+     struct Node : NodeKeyPrefix<K>
      {
          K key;                           // Search key
          V val;                           // Associated value
@@ -104,13 +186,14 @@
          Node *right{nullptr};            // Right child (larger keys)
  
          mutable std::shared_mutex rw;    // Per-node reader-writer lock
+         std::atomic<uint64_t> version{0}; // Bumped around every relink of left/right
          
          // ✅ DEADLOCK PREVENTION: Unique ordering ID based on memory address
          // Ensures consistent lock acquisition order across all threads
          const uintptr_t lock_id;
  
          explicit Node(const K &k, const V &v, Color c = Color::RED) 
-             : key(k), val(v), color(c), lock_id(reinterpret_cast<uintptr_t>(this)) {}
+             : NodeKeyPrefix<K>(k), key(k), val(v), color(c), lock_id(reinterpret_cast<uintptr_t>(this)) {}
      };
  
      /*═══════════════════════════════════════════════════════════════════════════
@@ -134,6 +217,7 @@
      private:
          using NodeT = Node<K, V>;
          std::vector<std::shared_lock<std::shared_mutex>> locks_;
+         std::shared_lock<std::shared_mutex> pair_[2];   // Two-node form
          
      public:
          explicit OrderedLockGuard(std::vector<NodeT*> nodes)
@@ -152,253 +236,1818 @@
              }
          }
          
+         // Two-node form used by lock coupling: same order, no heap allocation
+         OrderedLockGuard(NodeT *a, NodeT *b)
+         {
+             if (b->lock_id < a->lock_id)
+                 std::swap(a, b);
+             pair_[0] = std::shared_lock<std::shared_mutex>(a->rw);
+             if (b != a)
+                 pair_[1] = std::shared_lock<std::shared_mutex>(b->rw);
+         }
+         
          // RAII: Destructor automatically releases all locks in reverse order
          // This ensures proper cleanup even during exceptions
      };
  
      /*═══════════════════════════════════════════════════════════════════════════
-      * RBTree Class - Main Concurrent Red-Black Tree Implementation
+      * PhaseFairRWLock - Reader-Writer Lock with Bounded Writer Wait
       *═══════════════════════════════════════════════════════════════════════════
-      * CORE DESIGN DECISIONS:
-      * 
-      * 1. **NIL Sentinel Pattern**: Uses a shared NIL node instead of nullptr
-      *    - Simplifies traversal logic (no null checks)
-      *    - NIL is BLACK, maintains RB-tree properties at leaves
-      *    - Enables uniform handling of edge cases
+      * PROBLEM: std::shared_mutex (pthread_rwlock on glibc) prefers readers, so
+      * a steady flood of lookup_hybrid() calls can hold off insert_hybrid()
+      * indefinitely - writer latency grows with reader load, not with work.
       *
-      * 2. **Writer Serialization**: Global writers_mutex ensures only one writer
-      *    - Eliminates complex writer-writer race conditions
-      *    - Simplifies reasoning about tree modifications
-      *    - Rotations and rebalancing are atomic w.r.t. other writers
+      * SOLUTION: Phase-fair ticket lock (Brandenburg & Anderson, "PF-T"):
+      * - Writers take FIFO tickets (win/wout) and are served in arrival order
+      * - A waiting writer sets presence bits in rin, which stops NEW readers
+      *   while the readers already inside drain out (rout catches up)
+      * - Readers blocked by writer N are released as soon as N leaves, even if
+      *   writer N+1 is already queued (the phase-id bit differs)
       *
-      * 3. **Multiple Reader Strategies**: Three different approaches for reads
-      *    - Allows choosing best strategy based on workload characteristics
-      *    - Each strategy trades off simplicity vs. parallelism vs. performance
+      * GUARANTEE: Reader and writer phases alternate, so a writer waits for at
+      * most one reader phase plus the writers queued ahead of it, and a reader
+      * waits for at most one writer phase. Satisfies the SharedMutex
+      * requirements, so it drops into std::shared_lock / std::unique_lock.
+      *
+      * COUNTER LAYOUT (rin/rout):
+      *   bits 8..31: reader arrivals / departures (RINC per reader)
+      *   bit  1    : writer present (PRES)
+      *   bit  0    : writer phase id (PHID, alternates per writer ticket)
       *═══════════════════════════════════════════════════════════════════════════*/
-     template <typename K, typename V, typename Compare = std::less<K>>
-     class RBTree
+     class PhaseFairRWLock
      {
+     private:
+         static constexpr uint32_t RINC  = 0x100;  // Reader increment
+         static constexpr uint32_t WBITS = 0x3;    // Writer bits in rin
+         static constexpr uint32_t PRES  = 0x2;    // Writer present
+         static constexpr uint32_t PHID  = 0x1;    // Writer phase id
+ 
+         // Readers hammer rin/rout, writers hammer win/wout: keep them apart
+         alignas(64) std::atomic<uint32_t> rin{0};
+         alignas(64) std::atomic<uint32_t> rout{0};
+         alignas(64) std::atomic<uint32_t> win{0};
+         alignas(64) std::atomic<uint32_t> wout{0};
+ 
+         // Spin briefly, then yield so oversubscribed hosts still make progress
+         template <typename Pred>
+         static void spin_until(Pred done)
+         {
+             for (unsigned spins = 0; !done(); ++spins)
+             {
+                 if (spins >= 64)
+                     std::this_thread::yield();
+             }
+         }
+ 
      public:
-         using NodeT = Node<K, V>;
+         PhaseFairRWLock() = default;
+         PhaseFairRWLock(const PhaseFairRWLock &) = delete;
+         PhaseFairRWLock &operator=(const PhaseFairRWLock &) = delete;
  
-         /*───────────────────────────────────────────────────────────────────────
-          * Constructor - Initialize Empty Tree
-          *───────────────────────────────────────────────────────────────────────
-          * Creates the shared NIL sentinel node that serves as:
-          * - Target for all leaf pointers (no nullptr usage)
-          * - BLACK node maintaining RB-tree property #3
-          * - Simplifies rotation and traversal algorithms
-          *───────────────────────────────────────────────────────────────────────*/
-         RBTree()
+         void lock_shared()
          {
-             NIL = new NodeT(K{}, V{}, Color::BLACK); // Dummy key/val, permanent BLACK
-             root = NIL;                              // Empty tree: root points to NIL
+             // Announce arrival; if a writer is present wait for ITS phase to end
+             uint32_t w = rin.fetch_add(RINC, std::memory_order_acquire) & WBITS;
+             if (w != 0)
+                 spin_until([&] { return (rin.load(std::memory_order_acquire) & WBITS) != w; });
          }
  
-         /*───────────────────────────────────────────────────────────────────────
-          * Destructor - Clean Up All Nodes
-          *───────────────────────────────────────────────────────────────────────
-          * Post-order traversal ensures children are deleted before parents.
-          * Safe because destruction happens when no other threads have references.
-          *───────────────────────────────────────────────────────────────────────*/
-         ~RBTree()
+         bool try_lock_shared()
          {
-             destroy_rec(root);  // Recursive cleanup of real nodes
-             delete NIL;         // Finally delete the shared sentinel
+             uint32_t cur = rin.load(std::memory_order_relaxed);
+             while ((cur & WBITS) == 0)
+             {
+                 if (rin.compare_exchange_weak(cur, cur + RINC,
+                                               std::memory_order_acquire,
+                                               std::memory_order_relaxed))
+                     return true;
+             }
+             return false;  // Writer present or queued: do not barge ahead of it
          }
  
-         // Rule of Five: Disable copying (would corrupt mutex states and double-delete)
-         RBTree(const RBTree &) = delete;
-         RBTree &operator=(const RBTree &) = delete;
+         void unlock_shared()
+         {
+             rout.fetch_add(RINC, std::memory_order_release);
+         }
  
-         // Expose writer mutex for external synchronization (e.g., validation)
-         std::mutex &writer_mutex() const { return writers_mutex; }
+         void lock()
+         {
+             // Step 1: FIFO among writers
+             uint32_t ticket = win.fetch_add(1, std::memory_order_relaxed);
+             spin_until([&] { return wout.load(std::memory_order_acquire) == ticket; });
  
-         /*═══════════════════════════════════════════════════════════════════════
-          * LOOKUP STRATEGY 1: Simple Serialization
-          *═══════════════════════════════════════════════════════════════════════
-          * APPROACH: All operations (readers and writers) acquire the same mutex
-          * 
-          * ADVANTAGES:
-          * ✅ Completely deadlock-free
-          * ✅ Simple implementation and reasoning
-          * ✅ Minimal code complexity
-          * ✅ Good performance under high contention
-          * ✅ No lock coupling overhead
-          *
-          * DISADVANTAGES:
-          * ❌ No reader parallelism (readers block each other)
-          * ❌ Readers and writers block each other
-          *
-          * BEST FOR: Most practical applications, high contention scenarios
-          *═══════════════════════════════════════════════════════════════════════*/
-         std::optional<V> lookup_simple(const K &k) const
+             // Step 2: Block new readers, then wait for readers already inside
+             uint32_t w = PRES | (ticket & PHID);
+             uint32_t readers_in = rin.fetch_add(w, std::memory_order_acq_rel);
+             spin_until([&] { return rout.load(std::memory_order_acquire) == readers_in; });
+         }
+ 
+         bool try_lock()
          {
-             std::lock_guard<std::mutex> lock(writers_mutex);
-             
-             const NodeT *curr = root;
-             while (curr != NIL)
+             uint32_t ticket = wout.load(std::memory_order_acquire);
+             if (rin.load(std::memory_order_relaxed) != rout.load(std::memory_order_relaxed))
+                 return false;  // Readers inside
+             if (!win.compare_exchange_strong(ticket, ticket + 1, std::memory_order_relaxed))
+                 return false;  // Another writer holds or awaits the lock
+ 
+             // A reader may have slipped in since the check; it is already
+             // inside, so draining it is bounded by one read-side section
+             uint32_t w = PRES | (ticket & PHID);
+             uint32_t readers_in = rin.fetch_add(w, std::memory_order_acq_rel);
+             spin_until([&] { return rout.load(std::memory_order_acquire) == readers_in; });
+             return true;
+         }
+ 
+         void unlock()
+         {
+             rin.fetch_and(~WBITS, std::memory_order_release);  // Release blocked readers
+             wout.fetch_add(1, std::memory_order_release);      // Admit next writer
+         }
+     };
+
+     /*═══════════════════════════════════════════════════════════════════════════
+      * CRC-32 (IEEE 802.3, reflected) - Checksums for On-Disk Formats
+      *═══════════════════════════════════════════════════════════════════════════*/
+     inline uint32_t crc32(const void *data, size_t len, uint32_t crc = 0)
+     {
+         static const auto table = [] {
+             std::array<uint32_t, 256> t{};
+             for (uint32_t i = 0; i < 256; ++i)
              {
-                 if (comp(k, curr->key))
-                     curr = curr->left;         // Search key < current → go left
-                 else if (comp(curr->key, k))
-                     curr = curr->right;        // Search key > current → go right
-                 else
-                     return curr->val;          // Found exact match
+                 uint32_t c = i;
+                 for (int b = 0; b < 8; ++b)
+                     c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                 t[i] = c;
              }
-             return std::nullopt;               // Key not found
-         }
+             return t;
+         }();
  
-         /*═══════════════════════════════════════════════════════════════════════
-          * LOOKUP STRATEGY 2: Deadlock-Safe Lock Coupling
-          *═══════════════════════════════════════════════════════════════════════
-          * APPROACH: Hand-over-hand locking with ordered acquisition to prevent
-          *           deadlocks, while allowing multiple concurrent readers
-          * 
-          * LOCK COUPLING PROTOCOL:
-          * 1. Acquire shared lock on current node
-          * 2. Determine next node to visit
-          * 3. Acquire shared lock on next node (in proper order)
-          * 4. Release lock on current node
-          * 5. Move to next node and repeat
-          * 
-          * DEADLOCK PREVENTION:
-          * - Compare lock_id values to determine acquisition order
-          * - If normal order (parent < child): standard coupling
-          * - If reverse order (parent > child): use OrderedLockGuard
-          *
-          * ADVANTAGES:
-          * ✅ Multiple readers can proceed concurrently
-          * ✅ Deadlock-free through ordered acquisition
-          * ✅ Writers still cooperate (no reader-writer deadlock)
-          *
-          * DISADVANTAGES:
-          * ❌ Complex implementation
-          * ❌ Overhead of lock acquisition/release
-          * ❌ Memory overhead for lock_id and OrderedLockGuard
-          *
-          * BEST FOR: Read-heavy workloads with low contention
-          *═══════════════════════════════════════════════════════════════════════*/
-         std::optional<V> lookup(const K &k) const
+         const auto *p = static_cast<const uint8_t *>(data);
+         crc = ~crc;
+         for (size_t i = 0; i < len; ++i)
+             crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+         return ~crc;
+     }
+ 
+     /*═══════════════════════════════════════════════════════════════════════════
+      * SnapshotHeader - Page 0 of a save_snapshot() File
+      *═══════════════════════════════════════════════════════════════════════════
+      * FILE LAYOUT (every section starts on a SNAPSHOT_PAGE boundary):
+      *
+      *   ┌──────────────┬─────────────────────────┬─────────────────────────┐
+      *   │ header page  │ keys[count] (ascending) │ vals[count]             │
+      *   └──────────────┴─────────────────────────┴─────────────────────────┘
+      *   0              keys_offset               vals_offset       file_size
+      *
+      * Keys and values are stored as separate dense arrays (raw bytes of the
+      * trivially copyable K / V) so a binary search only faults in key pages.
+      * Integers are in host byte order; byte_order detects foreign files.
+      *═══════════════════════════════════════════════════════════════════════════*/
+     constexpr uint32_t SNAPSHOT_VERSION = 1;
+     constexpr uint64_t SNAPSHOT_PAGE = 4096;
+     constexpr char SNAPSHOT_MAGIC[8] = {'R', 'B', 'T', 'S', 'N', 'A', 'P', '\0'};
+ 
+     struct SnapshotHeader
+     {
+         char magic[8];              // SNAPSHOT_MAGIC
+         uint32_t version;           // SNAPSHOT_VERSION
+         uint32_t byte_order;        // 0x01020304 as written by the host
+         uint32_t key_size;          // sizeof(K)
+         uint32_t val_size;          // sizeof(V)
+         uint64_t count;             // Number of key/value pairs
+         uint64_t keys_offset;       // Page-aligned start of keys[]
+         uint64_t vals_offset;       // Page-aligned start of vals[]
+         uint64_t file_size;         // Expected total size
+         uint32_t keys_crc;          // crc32 of keys[]
+         uint32_t vals_crc;          // crc32 of vals[]
+         uint32_t header_crc;        // crc32 of all fields above
+         uint32_t reserved;
+     };
+ 
+     constexpr uint64_t snapshot_align(uint64_t off)
+     {
+         return (off + SNAPSHOT_PAGE - 1) & ~(SNAPSHOT_PAGE - 1);
+     }
+ 
+ 
+     /*═══════════════════════════════════════════════════════════════════════════
+      * EpochReclaimer - Deferred Free for Nodes Read Without Locks
+      *═══════════════════════════════════════════════════════════════════════════
+      * PROBLEM: Optimistic descents walk the tree without writers_mutex, so a
+      * concurrent erase() must not free a node that such a descent may still
+      * dereference (even if only to discover that its version changed).
+      *
+      * SOLUTION: Two-bucket epoch scheme driven by the (serialised) writer:
+      * - Readers pin the current epoch for the duration of a descent
+      * - Erased nodes are retired into the bucket of the current epoch
+      * - The writer advances the epoch once every reader pinned in the
+      *   previous epoch has left, then frees the nodes retired two epochs ago
+      *
+      * A node retired in epoch e is unlinked before the epoch moves to e+1, so
+      * readers pinned at e+1 or later can never reach it; readers pinned at
+      * <= e must all have unpinned before the epoch can reach e+2.
+      *
+      * THREADING: pin() from any thread; retire()/collect() only by the thread
+      * holding the tree's writers_mutex.
+      *═══════════════════════════════════════════════════════════════════════════*/
+     template <typename T>
+     class EpochReclaimer
+     {
+     private:
+         struct alignas(64) Slot
          {
-             if (root == NIL) return std::nullopt;  // Empty tree optimization
+             std::atomic<size_t> active{0};
+         };
  
-             const NodeT *curr = root;
-             
-             // Start with shared lock on root (no ordering issues for first lock)
-             std::shared_lock<std::shared_mutex> curr_lock(curr->rw);
+         std::atomic<uint64_t> epoch{0};
+         Slot slots[2];                      // Pinned readers per epoch parity
+         std::vector<T *> retired[2];        // Writer-owned retire buckets
+         std::vector<std::function<void()>> deferred[2];   // Same, for non-T objects
  
-             while (curr != NIL)
+     public:
+         // RAII epoch pin; release() lets a reader unpin before scope exit
+         class Pin
+         {
+         private:
+             Slot *slot_;
+ 
+         public:
+             explicit Pin(Slot *slot) : slot_(slot) {}
+             Pin(Pin &&other) noexcept : slot_(other.slot_) { other.slot_ = nullptr; }
+             Pin(const Pin &) = delete;
+             Pin &operator=(const Pin &) = delete;
+             ~Pin() { release(); }
+ 
+             void release()
              {
-                 if (comp(k, curr->key)) // Search key < current → go LEFT
-                 {
-                     const NodeT *next = curr->left;
-                     if (next == NIL) break;  // Reached leaf, key not found
-                     
-                     /*───────────────────────────────────────────────────────────
-                      * CRITICAL SECTION: Deadlock-Safe Lock Acquisition
-                      *───────────────────────────────────────────────────────────
-                      * Compare lock IDs to determine safe acquisition order:
-                      * - Normal case: parent_id < child_id (typical tree layout)
-                      * - Reverse case: parent_id > child_id (can happen with rotations)
-                      *───────────────────────────────────────────────────────────*/
-                     if (curr->lock_id < next->lock_id) {
-                         // NORMAL ORDER: Acquire child, then release parent
-                         std::shared_lock<std::shared_mutex> next_lock(next->rw);
-                         curr_lock.unlock();
-                         curr = next;
-                         curr_lock = std::move(next_lock);
-                     } else {
-                         // REVERSE ORDER: Use ordered acquisition to prevent deadlock
-                         std::vector<NodeT*> nodes = {const_cast<NodeT*>(curr), 
-                                                     const_cast<NodeT*>(next)};
-                         OrderedLockGuard<K,V> ordered_lock(nodes);
-                         
-                         // Now safe to transition without holding individual locks
-                         curr_lock.unlock();
-                         curr = next;
-                         curr_lock = std::shared_lock<std::shared_mutex>(curr->rw);
-                     }
-                 }
-                 else if (comp(curr->key, k)) // Search key > current → go RIGHT
-                 {
-                     const NodeT *next = curr->right;
-                     if (next == NIL) break;
-                     
-                     // Same deadlock prevention logic for right traversal
-                     if (curr->lock_id < next->lock_id) {
-                         std::shared_lock<std::shared_mutex> next_lock(next->rw);
-                         curr_lock.unlock();
-                         curr = next;
-                         curr_lock = std::move(next_lock);
-                     } else {
-                         std::vector<NodeT*> nodes = {const_cast<NodeT*>(curr), 
-                                                     const_cast<NodeT*>(next)};
-                         OrderedLockGuard<K,V> ordered_lock(nodes);
-                         
-                         curr_lock.unlock();
-                         curr = next;
-                         curr_lock = std::shared_lock<std::shared_mutex>(curr->rw);
-                     }
-                 }
-                 else // FOUND: search key == current key
-                 {
-                     return curr->val;
-                 }
+                 if (slot_)
+                     slot_->active.fetch_sub(1, std::memory_order_release);
+                 slot_ = nullptr;
              }
-             return std::nullopt; // Traversal ended at NIL, key not present
+         };
+ 
+         EpochReclaimer() = default;
+         EpochReclaimer(const EpochReclaimer &) = delete;
+         EpochReclaimer &operator=(const EpochReclaimer &) = delete;
+ 
+         ~EpochReclaimer()
+         {
+             for (auto &bucket : retired)
+                 for (T *p : bucket)
+                     delete p;
+             for (auto &bucket : deferred)
+                 for (auto &fn : bucket)
+                     fn();
          }
  
-         /*═══════════════════════════════════════════════════════════════════════
-          * LOOKUP STRATEGY 3: Global Reader-Writer Lock
-          *═══════════════════════════════════════════════════════════════════════
-          * APPROACH: Use std::shared_mutex for coarse-grained reader-writer sync
-          *
-          * CONCURRENCY MODEL:
-          * - Readers: Acquire shared_lock (multiple readers concurrent)
-          * - Writers: Acquire unique_lock (exclusive access)
-          * - No per-node locking during traversal
-          *
-          * ADVANTAGES:
-          * ✅ Excellent reader parallelism
-          * ✅ Simple implementation
-          * ✅ No deadlock concerns
-          * ✅ Low overhead per operation
-          *
-          * DISADVANTAGES:
-          * ❌ Readers can starve writers (std::shared_mutex issue)
-          * ❌ Less fine-grained than lock coupling
-          *
-          * BEST FOR: Read-dominated workloads with infrequent writes
-          *═══════════════════════════════════════════════════════════════════════*/
-         std::optional<V> lookup_hybrid(const K &k) const
+         Pin pin()
          {
-             std::shared_lock<std::shared_mutex> global_lock(global_rw_lock);
-             
-             // Simple traversal under global shared lock protection
-             const NodeT *curr = root;
-             while (curr != NIL)
+             for (;;)
              {
-                 if (comp(k, curr->key))
-                     curr = curr->left;
-                 else if (comp(curr->key, k))
-                     curr = curr->right;
-                 else
-                     return curr->val;
+                 uint64_t e = epoch.load(std::memory_order_seq_cst);
+                 Slot &slot = slots[e & 1];
+                 slot.active.fetch_add(1, std::memory_order_seq_cst);
+                 if (epoch.load(std::memory_order_seq_cst) == e)
+                     return Pin(&slot);
+                 slot.active.fetch_sub(1, std::memory_order_relaxed);  // Raced an advance
              }
-             return std::nullopt;
          }
  
-         /*═══════════════════════════════════════════════════════════════════════
-          * INSERT OPERATION - Thread-Safe Tree Insertion
-          *═══════════════════════════════════════════════════════════════════════
-          * CONCURRENCY STRATEGY: Writer serialization via global mutex
-          * - Only one writer can execute at a time
-          * - No per-node locking needed during insertion
+         void retire(T *p)
+         {
+             retired[epoch.load(std::memory_order_relaxed) & 1].push_back(p);
+         }
+ 
+         // retire() for anything else readers may still see (e.g. a replaced filter)
+         void defer(std::function<void()> fn)
+         {
+             deferred[epoch.load(std::memory_order_relaxed) & 1].push_back(std::move(fn));
+         }
+ 
+         // Advance the epoch if the previous one has drained; free what became safe
+         void collect()
+         {
+             uint64_t e = epoch.load(std::memory_order_relaxed);
+             if (retired[0].empty() && retired[1].empty() &&
+                 deferred[0].empty() && deferred[1].empty())
+                 return;
+             if (slots[(e + 1) & 1].active.load(std::memory_order_seq_cst) != 0)
+                 return;
+             epoch.store(e + 1, std::memory_order_seq_cst);
+ 
+             auto &bucket = retired[(e + 1) & 1];    // Retired during epoch e-1
+             for (T *p : bucket)
+                 delete p;
+             bucket.clear();
+             for (auto &fn : deferred[(e + 1) & 1])
+                 fn();
+             deferred[(e + 1) & 1].clear();
+         }
+ 
+         size_t retired_count() const { return retired[0].size() + retired[1].size(); }
+     };
+ 
+     /*═══════════════════════════════════════════════════════════════════════════
+      * HotKeyCache - Set-Associative Front Cache for Skewed Lookups
+      *═══════════════════════════════════════════════════════════════════════════
+      * PROBLEM: Under zipfian key distributions a handful of keys take most of
+      * the lookups, yet every RBTree::lookup() still couples ~2·log2(n) latches
+      * from the root down.
+      *
+      * SOLUTION: A fixed-size, power-of-two number of sets of WAYS slots, each
+      * set cache-line aligned. A key hashes to exactly one set, so a hit costs
+      * one hash, one set and no locks. A set is the 16-byte epoch header plus
+      * WAYS slots of (2 + WORDS) words: two lines for <int, int> (128 bytes),
+      * more for wider payloads.
+      * - Each slot is a seqlock: seq odd = slot being written; readers copy
+      *   the payload and skip the slot if seq changed meanwhile
+      * - Payload is stored as relaxed atomic words (no data race on the bytes)
+      * - Fill on hit: after a tree hit, the reader installs (k, v) - but only
+      *   if no writer invalidated the set since the miss (set epoch ticket).
+      *   Into a full set only one fill in ADMIT_ONE_IN is admitted: hot keys
+      *   come back often enough to get in, one-off cold keys mostly do not
+      * - Precise invalidation: a writer that overwrites or erases k bumps the
+      *   set epoch, then clears every slot holding k in that set
+      *
+      * The epoch closes the stale-fill race: a reader that read v1 from the
+      * tree before a writer replaced it with v2 took its ticket before the
+      * bump, so its fill either fails the epoch check or lands before the
+      * writer's slot sweep and is cleared by it (both sides use seq_cst on
+      * epoch and slot seq, so one of them always observes the other).
+      *
+      * THREADING: find()/fill() from any thread; invalidate() by the writer
+      * after the tree modification is visible. Keys and values must be
+      * trivially copyable.
+      *═══════════════════════════════════════════════════════════════════════════*/
+     struct HotCacheStats
+     {
+         uint64_t hits = 0;
+         uint64_t misses = 0;
+         uint64_t fills = 0;
+         uint64_t invalidations = 0;
+ 
+         double hit_rate() const
+         {
+             uint64_t total = hits + misses;
+             return total ? static_cast<double>(hits) / static_cast<double>(total) : 0.0;
+         }
+     };
+ 
+     // std::hash<K> is usable. The hashed accelerators (hot-key cache, negative
+     // filter) compile out for keys without one; ordering needs only Compare.
+     template <typename K, typename = void>
+     struct is_hashable : std::false_type {};
+     template <typename K>
+     struct is_hashable<K, std::void_t<decltype(std::hash<K>{}(std::declval<const K &>()))>> : std::true_type {};
+     template <typename K>
+     inline constexpr bool is_hashable_v = is_hashable<K>::value;
+ 
+     template <typename K, typename V, typename Compare = std::less<K>>
+     class HotKeyCache
+     {
+     private:
+         static constexpr size_t WAYS = 4;
+         static constexpr size_t WORDS = (sizeof(K) + sizeof(V) + 7) / 8;
+         static constexpr size_t STRIPES = 16;   // Hit counters, spread over threads
+         static constexpr uint32_t ADMIT_ONE_IN = 8;
+ 
+         struct Slot
+         {
+             std::atomic<uint64_t> seq{0};                   // Odd while being written
+             std::atomic<uint64_t> full{0};                  // Payload holds a live entry
+             std::array<std::atomic<uint64_t>, WORDS> words{}; // Key bytes, then value bytes
+         };
+ 
+         struct alignas(64) Set
+         {
+             std::atomic<uint64_t> epoch{0};     // Bumped by every invalidate() of the set
+             std::atomic<uint32_t> next{0};      // Round-robin victim
+             Slot slots[WAYS];
+         };
+ 
+         struct alignas(64) Counters
+         {
+             std::atomic<uint64_t> hits{0};
+             std::atomic<uint64_t> misses{0};
+             std::atomic<uint64_t> fills{0};
+             std::atomic<uint64_t> invalidations{0};
+         };
+ 
+         std::unique_ptr<Set[]> sets;
+         size_t mask;
+         Compare comp;
+         mutable Counters counters[STRIPES];
+ 
+         Set &set_of(const K &k) const
+         {
+             // Fibonacci hashing: std::hash is the identity for integers
+             uint64_t h = static_cast<uint64_t>(std::hash<K>{}(k)) * 0x9E3779B97F4A7C15ull;
+             return sets[(h >> 32) & mask];
+         }
+ 
+         Counters &local_counters() const
+         {
+             static thread_local const size_t stripe =
+                 std::hash<std::thread::id>{}(std::this_thread::get_id()) % STRIPES;
+             return counters[stripe];
+         }
+ 
+         bool equivalent(const K &a, const K &b) const { return !comp(a, b) && !comp(b, a); }
+ 
+         static void load_payload(const Slot &s, K &k, V &v)
+         {
+             uint64_t buf[WORDS];
+             for (size_t i = 0; i < WORDS; ++i)
+                 buf[i] = s.words[i].load(std::memory_order_relaxed);
+             std::memcpy(&k, buf, sizeof(K));
+             std::memcpy(&v, reinterpret_cast<const char *>(buf) + sizeof(K), sizeof(V));
+         }
+ 
+         static void store_payload(Slot &s, const K &k, const V &v)
+         {
+             uint64_t buf[WORDS] = {};
+             std::memcpy(buf, &k, sizeof(K));
+             std::memcpy(reinterpret_cast<char *>(buf) + sizeof(K), &v, sizeof(V));
+             for (size_t i = 0; i < WORDS; ++i)
+                 s.words[i].store(buf[i], std::memory_order_relaxed);
+         }
+ 
+         // Seqlock read of one slot; false if empty, mid-write or torn
+         static bool read_slot(const Slot &s, K &k, V &v)
+         {
+             uint64_t s1 = s.seq.load(std::memory_order_acquire);
+             if (s1 & 1) return false;
+             bool full = s.full.load(std::memory_order_relaxed) != 0;
+             if (full) load_payload(s, k, v);
+             std::atomic_thread_fence(std::memory_order_acquire);
+             return full && s.seq.load(std::memory_order_relaxed) == s1;
+         }
+ 
+         static bool try_lock_slot(Slot &s, uint64_t &seq)
+         {
+             seq = s.seq.load(std::memory_order_relaxed);
+             if ((seq & 1) || !s.seq.compare_exchange_strong(seq, seq + 1, std::memory_order_seq_cst))
+                 return false;
+             std::atomic_thread_fence(std::memory_order_release);   // seq odd before payload stores
+             return true;
+         }
+ 
+         static void unlock_slot(Slot &s, uint64_t seq)
+         {
+             s.seq.store(seq + 2, std::memory_order_release);
+         }
+ 
+     public:
+         // Captured on a miss; fill() succeeds only if the set was not invalidated since
+         struct Ticket
+         {
+             uint64_t epoch = 0;
+         };
+ 
+         explicit HotKeyCache(size_t min_sets, Compare c = Compare{}) : comp(c)
+         {
+             static_assert(std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V>,
+                           "HotKeyCache stores keys and values as raw words");
+             size_t n = 1;
+             while (n < min_sets) n <<= 1;
+             sets.reset(new Set[n]);
+             mask = n - 1;
+         }
+ 
+         HotKeyCache(const HotKeyCache &) = delete;
+         HotKeyCache &operator=(const HotKeyCache &) = delete;
+ 
+         size_t capacity() const { return (mask + 1) * WAYS; }
+ 
+         std::optional<V> find(const K &k, Ticket &ticket) const
+         {
+             const Set &set = set_of(k);
+             ticket.epoch = set.epoch.load(std::memory_order_seq_cst);   // Before the tree read
+             for (const Slot &s : set.slots)
+             {
+                 K key;
+                 V val;
+                 if (read_slot(s, key, val) && equivalent(key, k))
+                 {
+                     local_counters().hits.fetch_add(1, std::memory_order_relaxed);
+                     return val;
+                 }
+             }
+             local_counters().misses.fetch_add(1, std::memory_order_relaxed);
+             return std::nullopt;
+         }
+ 
+         // Install (k, v) read from the tree after find() missed with `ticket`
+         void fill(const K &k, const V &v, const Ticket &ticket)
+         {
+             Set &set = set_of(k);
+             if (set.epoch.load(std::memory_order_relaxed) != ticket.epoch) return;
+ 
+             // Victim: a slot already holding k, else an empty one, else round-robin
+             size_t victim = WAYS;
+             for (size_t w = 0; w < WAYS && victim == WAYS; ++w)
+             {
+                 K key;
+                 V val;
+                 if (read_slot(set.slots[w], key, val) && equivalent(key, k)) victim = w;
+             }
+             for (size_t w = 0; w < WAYS && victim == WAYS; ++w)
+                 if (!set.slots[w].full.load(std::memory_order_relaxed)) victim = w;
+             if (victim == WAYS)
+             {
+                 // Full set: admit only 1 in ADMIT_ONE_IN candidates, so a stream
+                 // of one-off cold keys cannot flush the keys that are hot
+                 static thread_local uint32_t rng = 0x9E3779B9u ^
+                     static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+                 rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;   // xorshift32
+                 if (rng % ADMIT_ONE_IN != 0) return;
+                 victim = set.next.fetch_add(1, std::memory_order_relaxed) % WAYS;
+             }
+ 
+             Slot &s = set.slots[victim];
+             uint64_t seq;
+             if (!try_lock_slot(s, seq)) return;     // Contended: skip, it is only a cache
+             if (set.epoch.load(std::memory_order_seq_cst) == ticket.epoch)
+             {
+                 store_payload(s, k, v);
+                 s.full.store(1, std::memory_order_relaxed);
+                 local_counters().fills.fetch_add(1, std::memory_order_relaxed);
+             }
+             unlock_slot(s, seq);
+         }
+ 
+         // Drop every cached copy of k; call after the tree no longer maps k to the old value
+         void invalidate(const K &k)
+         {
+             Set &set = set_of(k);
+             set.epoch.fetch_add(1, std::memory_order_seq_cst);
+             for (Slot &s : set.slots)
+             {
+                 uint64_t seq;
+                 while (!try_lock_slot(s, seq))
+                     std::this_thread::yield();     // A fill in progress; it is short
+                 if (s.full.load(std::memory_order_relaxed))
+                 {
+                     K key;
+                     V val;
+                     load_payload(s, key, val);
+                     if (equivalent(key, k)) s.full.store(0, std::memory_order_relaxed);
+                 }
+                 unlock_slot(s, seq);
+             }
+             local_counters().invalidations.fetch_add(1, std::memory_order_relaxed);
+         }
+ 
+         // Drop everything (e.g. before the tree is rebuilt)
+         void clear()
+         {
+             for (size_t i = 0; i <= mask; ++i)
+             {
+                 sets[i].epoch.fetch_add(1, std::memory_order_seq_cst);
+                 for (Slot &s : sets[i].slots)
+                 {
+                     uint64_t seq;
+                     while (!try_lock_slot(s, seq))
+                         std::this_thread::yield();
+                     s.full.store(0, std::memory_order_relaxed);
+                     unlock_slot(s, seq);
+                 }
+             }
+         }
+ 
+         size_t bytes() const { return (mask + 1) * sizeof(Set); }
+ 
+         HotCacheStats stats() const
+         {
+             HotCacheStats out;
+             for (const Counters &c : counters)
+             {
+                 out.hits += c.hits.load(std::memory_order_relaxed);
+                 out.misses += c.misses.load(std::memory_order_relaxed);
+                 out.fills += c.fills.load(std::memory_order_relaxed);
+                 out.invalidations += c.invalidations.load(std::memory_order_relaxed);
+             }
+             return out;
+         }
+     };
+ 
+     /*═══════════════════════════════════════════════════════════════════════════
+      * CountingBloomFilter - Negative-Lookup Filter with Deletion
+      *═══════════════════════════════════════════════════════════════════════════
+      * PROBLEM: Most stress-test lookups miss, and every miss still couples
+      * latches all the way down to a leaf.
+      *
+      * SOLUTION: A blocked counting Bloom filter. Each key maps to one 64-byte
+      * block and PROBES 8-bit counters inside it, so a query costs one cache
+      * line. Any zero counter proves the key absent; counters (rather than
+      * bits) let erase() remove a key exactly, so deletions do not leave
+      * stale positives behind.
+      *
+      * Counters wrap modulo 256 instead of saturating: a concurrent rebuild
+      * may see a remove() before the matching add(), and modular arithmetic
+      * keeps the final value exact. Overflow needs 256 live keys on one
+      * counter, far beyond the Poisson tail at the sizes used here.
+      *
+      * THREADING: may_contain() from any thread; add()/remove() by writers
+      * (fetch_add/fetch_sub, so a rebuild thread may add concurrently).
+      * std::hash<K> must agree with Compare's equivalence.
+      *═══════════════════════════════════════════════════════════════════════════*/
+     template <typename K>
+     class CountingBloomFilter
+     {
+     private:
+         static constexpr unsigned PROBES = 7;      // Optimal for ~10 counters per key
+ 
+         struct alignas(64) Block
+         {
+             std::atomic<uint8_t> counters[64];
+         };
+ 
+         std::unique_ptr<Block[]> blocks;
+         size_t mask;
+         size_t expected;
+ 
+         static uint64_t mix(uint64_t h)            // splitmix64 finalizer
+         {
+             h ^= h >> 30; h *= 0xBF58476D1CE4E5B9ull;
+             h ^= h >> 27; h *= 0x94D049BB133111EBull;
+             return h ^ (h >> 31);
+         }
+ 
+         // Block index from the high half, counter positions 6 bits at a time
+         template <typename Fn>
+         void for_each_counter(const K &k, Fn fn) const
+         {
+             uint64_t h = mix(static_cast<uint64_t>(std::hash<K>{}(k)));
+             Block &b = blocks[(h >> 32) & mask];
+             uint64_t pos = mix(h);
+             for (unsigned i = 0; i < PROBES; ++i, pos >>= 6)
+                 if (!fn(b.counters[pos & 63])) return;
+         }
+ 
+     public:
+         CountingBloomFilter(size_t expected_keys, size_t counters_per_key)
+             : expected(expected_keys)
+         {
+             size_t want = (std::max<size_t>(expected_keys, 1) * counters_per_key + 63) / 64;
+             size_t n = 1;
+             while (n < want) n <<= 1;
+             blocks.reset(new Block[n]);
+             for (size_t i = 0; i < n; ++i)
+                 for (auto &c : blocks[i].counters)
+                     c.store(0, std::memory_order_relaxed);
+             mask = n - 1;
+         }
+ 
+         void add(const K &k)
+         {
+             for_each_counter(k, [](std::atomic<uint8_t> &c) {
+                 c.fetch_add(1, std::memory_order_relaxed);
+                 return true;
+             });
+         }
+ 
+         void remove(const K &k)
+         {
+             for_each_counter(k, [](std::atomic<uint8_t> &c) {
+                 c.fetch_sub(1, std::memory_order_relaxed);
+                 return true;
+             });
+         }
+ 
+         // false: k is definitely not in the set
+         bool may_contain(const K &k) const
+         {
+             bool present = true;
+             for_each_counter(k, [&](std::atomic<uint8_t> &c) {
+                 present = c.load(std::memory_order_relaxed) != 0;
+                 return present;
+             });
+             return present;
+         }
+ 
+         size_t design_keys() const { return expected; }
+         size_t counters() const { return (mask + 1) * 64; }
+ 
+         // Standard Bloom estimate (1 - e^(-k·n/m))^k for n live keys
+         double estimated_fpr(size_t keys) const
+         {
+             double fill = 1.0 - std::exp(-double(PROBES) * double(keys) / double(counters()));
+             return std::pow(fill, PROBES);
+         }
+     };
+ 
+     struct NegativeFilterStats
+     {
+         bool enabled = false;
+         size_t keys = 0;                // Live keys the filter currently tracks
+         size_t design_keys = 0;         // Keys the active filter was sized for
+         double estimated_fpr = 0.0;     // At the current key count
+         size_t rebuilds = 0;            // Completed background rebuilds
+     };
+ 
+     /*═══════════════════════════════════════════════════════════════════════════
+      * StripedCounter - Scalable Statistics Counter
+      *═══════════════════════════════════════════════════════════════════════════
+      * One cache line per stripe; a thread always adds to the stripe its id
+      * hashes to, so threads updating the same counter (insert() next to
+      * insert_hybrid(), say) rarely share a line. load() sums the stripes:
+      * exact while writers are quiescent, a momentary estimate otherwise.
+      *═══════════════════════════════════════════════════════════════════════════*/
+     inline constexpr size_t COUNTER_STRIPES = 16;
+ 
+     // Stripe the calling thread adds to, fixed for the thread's lifetime
+     inline size_t local_stripe()
+     {
+         static thread_local const size_t stripe =
+             std::hash<std::thread::id>{}(std::this_thread::get_id()) % COUNTER_STRIPES;
+         return stripe;
+     }
+ 
+     class StripedCounter
+     {
+     private:
+         struct alignas(64) Stripe
+         {
+             std::atomic<int64_t> value{0};
+         };
+ 
+         Stripe stripes[COUNTER_STRIPES];
+ 
+     public:
+         void add(int64_t delta)
+         {
+             stripes[local_stripe()].value.fetch_add(delta, std::memory_order_relaxed);
+         }
+ 
+         int64_t load() const
+         {
+             int64_t sum = 0;
+             for (const Stripe &s : stripes)
+                 sum += s.value.load(std::memory_order_relaxed);
+             return sum;
+         }
+     };
+ 
+     /*═══════════════════════════════════════════════════════════════════════════
+      * MemoryStats - Where a Tree's Bytes Go (RBTree::memory_stats)
+      *═══════════════════════════════════════════════════════════════════════════
+      * Per-node fields split sizeof(Node) into what the user stored and what
+      * the tree adds around it; allocator_slack estimates the heap's own cost
+      * per allocation (a size_t header, rounded up to 16 bytes, as glibc's
+      * malloc does). Memory that K or V own themselves (a long std::string's
+      * buffer) is not included, nor are erased nodes awaiting reclamation.
+      *═══════════════════════════════════════════════════════════════════════════*/
+     struct MemoryStats
+     {
+         size_t nodes = 0;               // Live nodes (== size())
+         size_t node_size = 0;           // sizeof(Node)
+         size_t payload_bytes = 0;       // Key + value
+         size_t lock_bytes = 0;          // rw latch, version, lock_id
+         size_t link_bytes = 0;          // parent / left / right
+         size_t other_bytes = 0;         // Color, inline key prefix
+         size_t padding_bytes = 0;       // Alignment padding inside the node
+         size_t allocator_slack = 0;     // Per-allocation header and rounding (estimate)
+         size_t fixed_bytes = 0;         // Tree object and NIL sentinel
+         size_t aux_bytes = 0;           // Hot cache and negative filter, if enabled
+ 
+         size_t bytes_per_node() const { return node_size + allocator_slack; }
+         size_t overhead_per_node() const { return bytes_per_node() - payload_bytes; }
+         size_t total_bytes() const { return nodes * bytes_per_node() + fixed_bytes + aux_bytes; }
+ 
+         double payload_fraction() const
+         {
+             size_t total = total_bytes();
+             return total ? double(nodes * payload_bytes) / double(total) : 0.0;
+         }
+     };
+ 
+     /*═══════════════════════════════════════════════════════════════════════════
+      * ShapeStats - Depth Profile of the Tree (RBTree::shape_stats())
+      *═══════════════════════════════════════════════════════════════════════════
+      * Depths count nodes on the path from the root, root = 1, which is the
+      * number of comparisons a lookup() for that key makes (OpStats measures
+      * the same path for the keys actually looked up). A "leaf path" ends at
+      * a node with a NIL child; a valid red-black tree keeps the longest leaf
+      * path within twice the shortest, so imbalance() <= 2.
+      *═══════════════════════════════════════════════════════════════════════════*/
+     struct ShapeStats
+     {
+         size_t nodes = 0;
+         size_t red_nodes = 0;
+         size_t height = 0;                      // Deepest node
+         size_t min_leaf_depth = 0;              // Shortest leaf path
+         size_t black_height = 0;                // BLACK nodes on a leaf path (max seen)
+         uint64_t depth_sum = 0;
+         std::vector<uint64_t> depth_histogram;  // [d] = nodes at depth d
+         size_t chunks = 0;                      // writers_mutex acquisitions taken
+ 
+         double mean_depth() const { return nodes ? double(depth_sum) / double(nodes) : 0.0; }
+         double imbalance() const { return min_leaf_depth ? double(height) / double(min_leaf_depth) : 0.0; }
+ 
+         // height over the perfectly balanced minimum, log2(nodes + 1)
+         double height_ratio() const { return nodes ? double(height) / std::log2(double(nodes) + 1.0) : 0.0; }
+     };
+ 
+     /*═══════════════════════════════════════════════════════════════════════════
+      * OpStats / OpCounters - Built-in Operation Counters (RBT_ENABLE_STATS)
+      *═══════════════════════════════════════════════════════════════════════════
+      * Compiled with -DRBT_ENABLE_STATS, every RBTree counts:
+      * - left/right rotations
+      * - insert_fixup / delete_fixup loop iterations, and how often each of
+      *   their cases (3 resp. 4, mirrored branches folded in) ran
+      * - latch-coupled and hybrid lookups that descended, and the nodes they
+      *   visited (mean path length)
+      * - acquisitions of writers_mutex, global_rw_lock and Node::rw on the
+      *   operation paths, split into uncontended (try_lock succeeded) and
+      *   contended (had to wait); administrative paths (bulk_load, filter
+      *   management) and OrderedLockGuard's out-of-order pairs are not counted
+      *
+      * Counters live in per-thread-stripe slots (one cache-line group per
+      * stripe, as StripedCounter) and are summed by op_stats(). Without the
+      * macro the tree holds no counters and every hook is an empty inline
+      * function; op_stats() then reports enabled == false.
+      *═══════════════════════════════════════════════════════════════════════════*/
+     struct LockCounts
+     {
+         uint64_t uncontended = 0;
+         uint64_t contended = 0;
+ 
+         double contended_fraction() const
+         {
+             uint64_t total = uncontended + contended;
+             return total ? double(contended) / double(total) : 0.0;
+         }
+     };
+ 
+     struct OpStats
+     {
+         bool enabled = false;                   // Built with RBT_ENABLE_STATS
+         uint64_t left_rotations = 0;
+         uint64_t right_rotations = 0;
+         uint64_t insert_fixup_iterations = 0;
+         uint64_t insert_cases[3] = {};          // Uncle red, triangle, line
+         uint64_t delete_fixup_iterations = 0;
+         uint64_t delete_cases[4] = {};          // Sibling red, nephews black, near red, far red
+         uint64_t lookups = 0;                   // Descents by lookup() / lookup_hybrid()
+         uint64_t lookup_nodes = 0;              // Nodes those descents visited
+         LockCounts writers_mutex;
+         LockCounts global_rw_lock;
+         LockCounts node_latch;
+ 
+         double mean_lookup_depth() const { return lookups ? double(lookup_nodes) / double(lookups) : 0.0; }
+     };
+ 
+     enum class OpEvent : size_t
+     {
+         LEFT_ROTATE, RIGHT_ROTATE,
+         INSERT_FIXUP_ITERATION, INSERT_CASE_1, INSERT_CASE_2, INSERT_CASE_3,
+         DELETE_FIXUP_ITERATION, DELETE_CASE_1, DELETE_CASE_2, DELETE_CASE_3, DELETE_CASE_4,
+         LOOKUP, LOOKUP_NODES,
+         WRITERS_FREE, WRITERS_WAIT,             // *_WAIT must follow its *_FREE
+         GLOBAL_FREE, GLOBAL_WAIT,
+         LATCH_FREE, LATCH_WAIT,
+         COUNT
+     };
+ 
+     class OpCounters
+     {
+     private:
+         static constexpr size_t EVENTS = static_cast<size_t>(OpEvent::COUNT);
+ 
+         struct alignas(64) Slot
+         {
+             std::atomic<uint64_t> n[EVENTS] = {};
+         };
+ 
+         Slot slots[COUNTER_STRIPES];
+ 
+         uint64_t sum(OpEvent e) const
+         {
+             uint64_t total = 0;
+             for (const Slot &slot : slots)
+                 total += slot.n[static_cast<size_t>(e)].load(std::memory_order_relaxed);
+             return total;
+         }
+ 
+         LockCounts lock_counts(OpEvent free) const
+         {
+             return {sum(free), sum(static_cast<OpEvent>(static_cast<size_t>(free) + 1))};
+         }
+ 
+     public:
+         void add(OpEvent e, uint64_t by)
+         {
+             slots[local_stripe()].n[static_cast<size_t>(e)].fetch_add(by, std::memory_order_relaxed);
+         }
+ 
+         void reset()
+         {
+             for (Slot &slot : slots)
+                 for (auto &c : slot.n)
+                     c.store(0, std::memory_order_relaxed);
+         }
+ 
+         OpStats snapshot() const
+         {
+             OpStats out;
+             out.enabled = true;
+             out.left_rotations = sum(OpEvent::LEFT_ROTATE);
+             out.right_rotations = sum(OpEvent::RIGHT_ROTATE);
+             out.insert_fixup_iterations = sum(OpEvent::INSERT_FIXUP_ITERATION);
+             for (size_t c = 0; c < 3; ++c)
+                 out.insert_cases[c] = sum(static_cast<OpEvent>(static_cast<size_t>(OpEvent::INSERT_CASE_1) + c));
+             out.delete_fixup_iterations = sum(OpEvent::DELETE_FIXUP_ITERATION);
+             for (size_t c = 0; c < 4; ++c)
+                 out.delete_cases[c] = sum(static_cast<OpEvent>(static_cast<size_t>(OpEvent::DELETE_CASE_1) + c));
+             out.lookups = sum(OpEvent::LOOKUP);
+             out.lookup_nodes = sum(OpEvent::LOOKUP_NODES);
+             out.writers_mutex = lock_counts(OpEvent::WRITERS_FREE);
+             out.global_rw_lock = lock_counts(OpEvent::GLOBAL_FREE);
+             out.node_latch = lock_counts(OpEvent::LATCH_FREE);
+             return out;
+         }
+     };
+ 
+     /*═══════════════════════════════════════════════════════════════════════════
+      * Lock Profiler - Wait / Hold Histograms per Call Site (RBT_PROFILE_LOCKS)
+      *═══════════════════════════════════════════════════════════════════════════
+      * Compiled with -DRBT_PROFILE_LOCKS, the global locks taken on RBTree's
+      * operation paths (writers_mutex, global_rw_lock) come back wrapped in a
+      * ProfiledLock. It timestamps the request, the acquisition and the
+      * release, and records wait (request → acquired) and hold (acquired →
+      * released) for its LockSite, e.g. which of insert / erase /
+      * insert_hybrid / validate_locked() held writers_mutex for how long.
+      *
+      * Durations go into log2 buckets of nanoseconds: bucket b counts samples
+      * in [2^b, 2^(b+1)) ns, so percentiles are reported as bucket upper
+      * bounds. As with OpCounters the buckets live in per-thread-stripe slots
+      * and lock_profile() sums them. Without the macro the guards are plain
+      * std::unique_lock / std::shared_lock and lock_profile() is empty.
+      *═══════════════════════════════════════════════════════════════════════════*/
+     enum class LockSite : size_t
+     {
+         INSERT, ERASE,                  // writers_mutex
+         INSERT_HYBRID, ERASE_HYBRID,    // global_rw_lock, exclusive
+         LOOKUP_SIMPLE,                  // writers_mutex (Strategy 1 read)
+         LOOKUP_HYBRID, BOUND_HYBRID,    // global_rw_lock, shared
+         VALIDATE,                       // writers_mutex over a full validate()
+         SHAPE_STATS,                    // writers_mutex per shape_stats() chunk
+         VALIDATE_SLICE,                 // writers_mutex per validate_slice()
+         COUNT
+     };
+ 
+     inline const char *lock_site_name(LockSite site)
+     {
+         static const char *const names[] = {"insert", "erase", "insert_hybrid", "erase_hybrid",
+                                             "lookup_simple", "lookup_hybrid", "bound_hybrid", "validate",
+                                             "shape_stats", "validate_slice"};
+         return names[static_cast<size_t>(site)];
+     }
+ 
+     struct LockTimeHistogram
+     {
+         static constexpr size_t BUCKETS = 32;   // Last bucket also holds everything >= 2^31 ns
+         uint64_t buckets[BUCKETS] = {};
+         uint64_t samples = 0;
+         uint64_t total_ns = 0;
+         uint64_t max_ns = 0;
+ 
+         double mean_ns() const { return samples ? double(total_ns) / double(samples) : 0.0; }
+ 
+         // Upper bound of the bucket holding the p-th percentile (p in 0..100)
+         uint64_t percentile_ns(double p) const
+         {
+             if (!samples)
+                 return 0;
+             uint64_t rank = static_cast<uint64_t>(p / 100.0 * double(samples - 1)) + 1;
+             uint64_t seen = 0;
+             for (size_t b = 0; b < BUCKETS; ++b)
+             {
+                 seen += buckets[b];
+                 if (seen >= rank)
+                     return std::min(max_ns, (uint64_t{2} << b) - 1);
+             }
+             return max_ns;
+         }
+     };
+ 
+     struct LockSiteProfile
+     {
+         LockSite site;
+         const char *name;
+         LockTimeHistogram wait;
+         LockTimeHistogram hold;
+     };
+ 
+     class LockProfiler
+     {
+     private:
+         static constexpr size_t SITES = static_cast<size_t>(LockSite::COUNT);
+         static constexpr size_t BUCKETS = LockTimeHistogram::BUCKETS;
+ 
+         struct Series
+         {
+             std::atomic<uint64_t> buckets[BUCKETS] = {};
+             std::atomic<uint64_t> samples{0};
+             std::atomic<uint64_t> total_ns{0};
+             std::atomic<uint64_t> max_ns{0};
+ 
+             void record(uint64_t ns)
+             {
+                 size_t b = 0;
+                 for (uint64_t v = ns; v > 1 && b + 1 < BUCKETS; v >>= 1)
+                     ++b;
+                 buckets[b].fetch_add(1, std::memory_order_relaxed);
+                 samples.fetch_add(1, std::memory_order_relaxed);
+                 total_ns.fetch_add(ns, std::memory_order_relaxed);
+                 uint64_t seen = max_ns.load(std::memory_order_relaxed);
+                 while (ns > seen && !max_ns.compare_exchange_weak(seen, ns, std::memory_order_relaxed))
+                 {
+                 }
+             }
+ 
+             void add_to(LockTimeHistogram &h) const
+             {
+                 for (size_t b = 0; b < BUCKETS; ++b)
+                     h.buckets[b] += buckets[b].load(std::memory_order_relaxed);
+                 h.samples += samples.load(std::memory_order_relaxed);
+                 h.total_ns += total_ns.load(std::memory_order_relaxed);
+                 h.max_ns = std::max(h.max_ns, max_ns.load(std::memory_order_relaxed));
+             }
+ 
+             void reset()
+             {
+                 for (auto &b : buckets)
+                     b.store(0, std::memory_order_relaxed);
+                 samples.store(0, std::memory_order_relaxed);
+                 total_ns.store(0, std::memory_order_relaxed);
+                 max_ns.store(0, std::memory_order_relaxed);
+             }
+         };
+ 
+         struct alignas(64) Slot
+         {
+             Series wait[SITES];
+             Series hold[SITES];
+         };
+ 
+         Slot slots[COUNTER_STRIPES];
+ 
+     public:
+         void record(LockSite site, uint64_t wait_ns, uint64_t hold_ns)
+         {
+             Slot &slot = slots[local_stripe()];
+             slot.wait[static_cast<size_t>(site)].record(wait_ns);
+             slot.hold[static_cast<size_t>(site)].record(hold_ns);
+         }
+ 
+         void reset()
+         {
+             for (Slot &slot : slots)
+                 for (size_t i = 0; i < SITES; ++i)
+                 {
+                     slot.wait[i].reset();
+                     slot.hold[i].reset();
+                 }
+         }
+ 
+         // Sites that recorded at least one acquisition
+         std::vector<LockSiteProfile> snapshot() const
+         {
+             std::vector<LockSiteProfile> out;
+             for (size_t i = 0; i < SITES; ++i)
+             {
+                 LockSiteProfile p{static_cast<LockSite>(i), lock_site_name(static_cast<LockSite>(i)), {}, {}};
+                 for (const Slot &slot : slots)
+                 {
+                     slot.wait[i].add_to(p.wait);
+                     slot.hold[i].add_to(p.hold);
+                 }
+                 if (p.wait.samples)
+                     out.push_back(p);
+             }
+             return out;
+         }
+     };
+ 
+     // A Lock plus the timestamps LockProfiler needs; records on unlock()
+     template <typename Lock>
+     class ProfiledLock
+     {
+     public:
+         using Clock = std::chrono::steady_clock;
+ 
+         ProfiledLock(Lock lock, LockProfiler &profiler, LockSite site, Clock::time_point requested)
+             : lock_(std::move(lock)), profiler_(&profiler), site_(site), acquired_(Clock::now()),
+               wait_ns_(nanos(acquired_ - requested)) {}
+ 
+         ProfiledLock(ProfiledLock &&other) noexcept
+             : lock_(std::move(other.lock_)), profiler_(std::exchange(other.profiler_, nullptr)),
+               site_(other.site_), acquired_(other.acquired_), wait_ns_(other.wait_ns_) {}
+ 
+         ProfiledLock &operator=(ProfiledLock &&) = delete;
+         ~ProfiledLock() { unlock(); }
+ 
+         bool owns_lock() const { return lock_.owns_lock(); }
+ 
+         void unlock()
+         {
+             if (!profiler_ || !lock_.owns_lock())
+                 return;
+             lock_.unlock();
+             profiler_->record(site_, wait_ns_, nanos(Clock::now() - acquired_));
+         }
+ 
+     private:
+         static uint64_t nanos(Clock::duration d)
+         {
+             return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+         }
+ 
+         Lock lock_;
+         LockProfiler *profiler_;
+         LockSite site_;
+         Clock::time_point acquired_;
+         uint64_t wait_ns_;
+     };
+ 
+     // One line per site: samples, then wait and hold as mean / p50 / p99 / max
+     inline void print_lock_profile(std::ostream &os, const std::vector<LockSiteProfile> &profile)
+     {
+         auto us = [](double ns) { return ns / 1000.0; };
+         os << std::left << std::setw(15) << "lock site" << std::right << std::setw(10) << "samples"
+            << "    wait us: mean        p50        p99        max    hold us: mean        p50        p99        max\n";
+         for (const LockSiteProfile &p : profile)
+         {
+             os << std::left << std::setw(15) << p.name << std::right << std::setw(10) << p.wait.samples
+                << std::fixed << std::setprecision(2);
+             for (const LockTimeHistogram *h : {&p.wait, &p.hold})
+                 os << "   " << std::setw(14) << us(h->mean_ns()) << std::setw(11) << us(double(h->percentile_ns(50)))
+                    << std::setw(11) << us(double(h->percentile_ns(99))) << std::setw(11) << us(double(h->max_ns));
+             os << "\n";
+         }
+     }
+ 
+     template <typename K, typename V, typename Compare>
+     class EytzingerTree;        // Read-only layout produced by RBTree::freeze()
+ 
+     // Compare::is_transparent (e.g. std::less<>): queries may take any Q the
+     // comparator can order against K, without building a K first. Q is a
+     // parameter only so that uses stay dependent (SFINAE in overload sets).
+     template <typename Compare, typename Q, typename = void>
+     struct is_transparent_for : std::false_type {};
+     template <typename Compare, typename Q>
+     struct is_transparent_for<Compare, Q, std::void_t<typename Compare::is_transparent>> : std::true_type {};
+ 
+     // Comparators may also expose int compare(a, b) (<0 / 0 / >0, consistent
+     // with operator()) so that descents need one comparison per level
+     template <typename Compare, typename A, typename B, typename = void>
+     struct has_three_way_compare : std::false_type {};
+     template <typename Compare, typename A, typename B>
+     struct has_three_way_compare<Compare, A, B,
+         std::void_t<decltype(int(std::declval<const Compare &>().compare(std::declval<const A &>(),
+                                                                          std::declval<const B &>())))>>
+         : std::true_type {};
+ 
+     /*═══════════════════════════════════════════════════════════════════════════
+      * RBTree Class - Main Concurrent Red-Black Tree Implementation
+      *═══════════════════════════════════════════════════════════════════════════
+      * CORE DESIGN DECISIONS:
+      * 
+      * 1. **NIL Sentinel Pattern**: Uses a shared NIL node instead of nullptr
+      *    - Simplifies traversal logic (no null checks)
+      *    - NIL is BLACK, maintains RB-tree properties at leaves
+      *    - Enables uniform handling of edge cases
+      *    - Read-only after construction: erase tracks x's parent itself, so
+      *      no writer ever stores into NIL and its cache line is never
+      *      invalidated under the readers that test every leaf against it
+      *
+      * 2. **Writer Serialization**: Global writers_mutex ensures only one writer
+      *    - Eliminates complex writer-writer race conditions
+      *    - Simplifies reasoning about tree modifications
+      *    - Rotations and rebalancing are atomic w.r.t. other writers
+      *
+      * 3. **Multiple Reader Strategies**: Three different approaches for reads
+      *    - Allows choosing best strategy based on workload characteristics
+      *    - Each strategy trades off simplicity vs. parallelism vs. performance
+      *
+      * 4. **Pluggable RW Lock Policy**: RWLock is the type of global_rw_lock
+      *    - std::shared_mutex (default): fastest readers, writers may starve
+      *    - PhaseFairRWLock: bounded writer wait under reader floods
+      *
+      * 5. **Heterogeneous Keys**: with a transparent Compare (std::less<>),
+      *    lookup*, erase* and the ordered queries also accept any type Q the
+      *    comparator orders against K (std::string_view for std::string keys),
+      *    so a probe never has to construct - and allocate - a K
+      *═══════════════════════════════════════════════════════════════════════════*/
+     template <typename K, typename V, typename Compare = std::less<K>,
+               typename RWLock = std::shared_mutex>
+     class RBTree
+     {
+     public:
+         using NodeT = Node<K, V>;
+ 
+         // Overload gates for heterogeneous keys: KeyArg admits K itself or (with a
+         // transparent Compare) any Q; IfTransparent only the latter, next to a
+         // plain const K& overload that keeps implicit conversions working
+         template <typename Q>
+         using KeyArg = std::enable_if_t<std::is_same_v<Q, K> || is_transparent_for<Compare, Q>::value, int>;
+         template <typename Q>
+         using IfTransparent = std::enable_if_t<is_transparent_for<Compare, Q>::value, int>;
+ 
+         /*───────────────────────────────────────────────────────────────────────
+          * Constructor - Initialize Empty Tree
+          *───────────────────────────────────────────────────────────────────────
+          * Creates the shared NIL sentinel node that serves as:
+          * - Target for all leaf pointers (no nullptr usage)
+          * - BLACK node maintaining RB-tree property #3
+          * - Simplifies rotation and traversal algorithms
+          * NIL gets cache lines of its own, so the first nodes malloc places
+          * next to it cannot drag it into their writers' coherence traffic.
+          *───────────────────────────────────────────────────────────────────────*/
+         RBTree()
+         {
+             NIL = new (::operator new(NIL_BYTES, NIL_ALIGN)) NodeT(K{}, V{}, Color::BLACK); // Dummy key/val, permanent BLACK
+             root = NIL;                              // Empty tree: root points to NIL
+             leftmost = rightmost = NIL;
+         }
+ 
+         /*───────────────────────────────────────────────────────────────────────
+          * Destructor - Clean Up All Nodes
+          *───────────────────────────────────────────────────────────────────────
+          * Iterative teardown (free_tree), fanned out over teardown_workers
+          * threads. Safe because destruction happens when no other threads
+          * have references; a clear_async() still in flight is waited for.
+          *───────────────────────────────────────────────────────────────────────*/
+         ~RBTree()
+         {
+             if (neg_rebuilder.joinable()) neg_rebuilder.join();   // Uses the tree
+             if (teardown_worker.joinable()) teardown_worker.join();
+             delete neg_filter.load(std::memory_order_relaxed);
+             free_tree(root, teardown_workers);  // Cleanup of real nodes
+             NIL->~NodeT();      // Finally delete the shared sentinel
+             ::operator delete(NIL, NIL_ALIGN);
+         }
+ 
+         // Rule of Five: Disable copying (would corrupt mutex states and double-delete)
+         RBTree(const RBTree &) = delete;
+         RBTree &operator=(const RBTree &) = delete;
+ 
+         // Expose writer mutex for external synchronization (e.g., validation)
+         std::mutex &writer_mutex() const { return writers_mutex; }
+ 
+         // Expose Strategy 3 lock (e.g., validation against insert_hybrid)
+         RWLock &global_mutex() const { return global_rw_lock; }
+ 
+         /*═══════════════════════════════════════════════════════════════════════
+          * LOOKUP STRATEGY 1: Simple Serialization
+          *═══════════════════════════════════════════════════════════════════════
+          * APPROACH: All operations (readers and writers) acquire the same mutex
+          * 
+          * ADVANTAGES:
+          * ✅ Completely deadlock-free
+          * ✅ Simple implementation and reasoning
+          * ✅ Minimal code complexity
+          * ✅ Good performance under high contention
+          * ✅ No lock coupling overhead
+          *
+          * DISADVANTAGES:
+          * ❌ No reader parallelism (readers block each other)
+          * ❌ Readers and writers block each other
+          *
+          * BEST FOR: Most practical applications, high contention scenarios
+          *═══════════════════════════════════════════════════════════════════════*/
+         std::optional<V> lookup_simple(const K &k) const
+         {
+             auto lock = lock_writers(LockSite::LOOKUP_SIMPLE);
+             
+             const NodeT *curr = root;
+             while (curr != NIL)
+             {
+                 int c = three_way(k, curr);
+                 if (c < 0)
+                     curr = curr->left;         // Search key < current → go left
+                 else if (c > 0)
+                     curr = curr->right;        // Search key > current → go right
+                 else
+                     return curr->val;          // Found exact match
+             }
+             return std::nullopt;               // Key not found
+         }
+ 
+         /*═══════════════════════════════════════════════════════════════════════
+          * LOOKUP STRATEGY 2: Deadlock-Safe Lock Coupling
+          *═══════════════════════════════════════════════════════════════════════
+          * APPROACH: Hand-over-hand locking with ordered acquisition to prevent
+          *           deadlocks, while allowing multiple concurrent readers
+          * 
+          * LOCK COUPLING PROTOCOL:
+          * 1. Acquire shared lock on current node
+          * 2. Determine next node to visit
+          * 3. Acquire shared lock on next node (in proper order)
+          * 4. Release lock on current node
+          * 5. Move to next node and repeat
+          * 
+          * DEADLOCK PREVENTION:
+          * - Compare lock_id values to determine acquisition order
+          * - If normal order (parent < child): standard coupling
+          * - If reverse order (parent > child): use OrderedLockGuard
+          *
+          * ADVANTAGES:
+          * ✅ Multiple readers can proceed concurrently
+          * ✅ Deadlock-free through ordered acquisition
+          * ✅ Writers still cooperate (no reader-writer deadlock)
+          *
+          * DISADVANTAGES:
+          * ❌ Complex implementation
+          * ❌ Overhead of lock acquisition/release
+          * ❌ Memory overhead for lock_id and OrderedLockGuard
+          *
+          * BEST FOR: Read-heavy workloads with low contention
+          *
+          * A heterogeneous Q bypasses the hot cache and negative filter, which
+          * are keyed and hashed by K.
+          *═══════════════════════════════════════════════════════════════════════*/
+         std::optional<V> lookup(const K &k) const { return lookup<K>(k); }
+ 
+         template <typename Q, KeyArg<Q> = 0>
+         std::optional<V> lookup(const Q &k) const
+         {
+             constexpr bool SAME_KEY = std::is_same_v<Q, K>;
+ 
+             // Hot keys are answered by the front cache without touching the tree
+             typename HotKeyCache<K, V, Compare>::Ticket ticket;
+             if constexpr (HOT_CACHEABLE && SAME_KEY)
+             {
+                 if (hot_cache)
+                     if (auto hit = hot_cache->find(k, ticket)) return hit;
+             }
+ 
+             // Erased nodes (and their rw latches) stay allocated while pinned
+             auto pin = reclaimer.pin();
+ 
+             // Definite misses skip the descent (the pin also covers a filter swap)
+             if constexpr (SAME_KEY && FILTERABLE)
+             {
+                 if (auto *f = neg_filter.load(std::memory_order_acquire); f && !f->may_contain(k))
+                     return std::nullopt;
+             }
+ 
+             if (root == NIL) return std::nullopt;  // Empty tree optimization
+ 
+             const NodeT *curr = root;
+             
+             // Start with shared lock on root (no ordering issues for first lock)
+             std::shared_lock<std::shared_mutex> curr_lock = latch_shared(curr);
+             size_t depth = 0;               // Nodes visited (RBT_ENABLE_STATS)
+ 
+             while (curr != NIL)
+             {
+                 ++depth;
+                 int c = three_way(k, curr);   // One comparison per level
+                 if (c < 0) // Search key < current → go LEFT
+                 {
+                     const NodeT *next = curr->left;
+                     if (next == NIL) break;  // Reached leaf, key not found
+                     
+                     /*───────────────────────────────────────────────────────────
+                      * CRITICAL SECTION: Deadlock-Safe Lock Acquisition
+                      *───────────────────────────────────────────────────────────
+                      * Compare lock IDs to determine safe acquisition order:
+                      * - Normal case: parent_id < child_id (typical tree layout)
+                      * - Reverse case: parent_id > child_id (can happen with rotations)
+                      *───────────────────────────────────────────────────────────*/
+                     if (curr->lock_id < next->lock_id) {
+                         // NORMAL ORDER: Acquire child, then release parent
+                         std::shared_lock<std::shared_mutex> next_lock = latch_shared(next);
+                         curr_lock.unlock();
+                         curr = next;
+                         curr_lock = std::move(next_lock);
+                     } else {
+                         // REVERSE ORDER: Use ordered acquisition to prevent deadlock
+                         OrderedLockGuard<K,V> ordered_lock(const_cast<NodeT*>(curr),
+                                                            const_cast<NodeT*>(next));
+                         
+                         // Now safe to transition without holding individual locks
+                         curr_lock.unlock();
+                         curr = next;
+                         curr_lock = latch_shared(curr);
+                     }
+                 }
+                 else if (c > 0) // Search key > current → go RIGHT
+                 {
+                     const NodeT *next = curr->right;
+                     if (next == NIL) break;
+                     
+                     // Same deadlock prevention logic for right traversal
+                     if (curr->lock_id < next->lock_id) {
+                         std::shared_lock<std::shared_mutex> next_lock = latch_shared(next);
+                         curr_lock.unlock();
+                         curr = next;
+                         curr_lock = std::move(next_lock);
+                     } else {
+                         OrderedLockGuard<K,V> ordered_lock(const_cast<NodeT*>(curr),
+                                                            const_cast<NodeT*>(next));
+                         
+                         curr_lock.unlock();
+                         curr = next;
+                         curr_lock = latch_shared(curr);
+                     }
+                 }
+                 else // FOUND: search key == current key
+                 {
+                     if constexpr (HOT_CACHEABLE && SAME_KEY)
+                     {
+                         if (hot_cache) hot_cache->fill(k, curr->val, ticket);
+                     }
+                     count_lookup(depth);
+                     return curr->val;
+                 }
+             }
+             count_lookup(depth);
+             return std::nullopt; // Traversal ended at NIL, key not present
+         }
+ 
+         /*═══════════════════════════════════════════════════════════════════════
+          * HOT-KEY CACHE - Optional Front Cache for lookup()
+          *═══════════════════════════════════════════════════════════════════════
+          * enable_hot_cache(sets) puts a HotKeyCache of `sets` (rounded up to a
+          * power of two) four-way sets in front of lookup(). Hits skip the
+          * descent entirely; every write path invalidates the key it
+          * overwrites or erases, so lookup() never returns a stale value.
+          * Pays off under skewed (zipfian) access; under uniform keys over a
+          * large tree the hit rate, and the win, stay small.
+          *
+          * Call before the tree is shared between threads. Requires trivially
+          * copyable K and V and a std::hash<K>.
+          *═══════════════════════════════════════════════════════════════════════*/
+         void enable_hot_cache(size_t sets = 1024)
+         {
+             static_assert(HOT_CACHEABLE, "enable_hot_cache() needs trivially copyable K and V and a std::hash<K>");
+             hot_cache = std::make_unique<HotKeyCache<K, V, Compare>>(sets, comp);
+         }
+ 
+         HotCacheStats hot_cache_stats() const
+         {
+             return hot_cache ? hot_cache->stats() : HotCacheStats{};
+         }
+ 
+         /*═══════════════════════════════════════════════════════════════════════
+          * SIZE / MEMORY ACCOUNTING - O(1), No Locks
+          *═══════════════════════════════════════════════════════════════════════
+          * Writers count linked and unlinked nodes in a StripedCounter; the
+          * per-node breakdown is compile-time layout. Under concurrent writes
+          * both are a momentary estimate, exact once writers are quiescent.
+          *═══════════════════════════════════════════════════════════════════════*/
+         size_t size() const
+         {
+             return static_cast<size_t>(std::max<int64_t>(0, live_nodes.load()));
+         }
+ 
+         MemoryStats memory_stats() const
+         {
+             MemoryStats out;
+             out.nodes = size();
+             out.node_size = sizeof(NodeT);
+             out.payload_bytes = sizeof(K) + sizeof(V);
+             out.lock_bytes = sizeof(std::shared_mutex) + sizeof(std::atomic<uint64_t>) + sizeof(uintptr_t);
+             out.link_bytes = 3 * sizeof(NodeT *);
+             out.other_bytes = sizeof(Color) + (std::is_empty_v<NodeKeyPrefix<K>> ? 0 : sizeof(NodeKeyPrefix<K>));
+             out.padding_bytes = out.node_size - out.payload_bytes - out.lock_bytes - out.link_bytes - out.other_bytes;
+             size_t chunk = std::max<size_t>(32, (sizeof(NodeT) + sizeof(size_t) + 15) & ~size_t{15});
+             out.allocator_slack = chunk - sizeof(NodeT);
+             out.fixed_bytes = sizeof(*this) + NIL_BYTES;
+ 
+             auto pin = reclaimer.pin();             // A replaced filter stays allocated
+             if (hot_cache) out.aux_bytes += hot_cache->bytes();
+             if (auto *f = neg_filter.load(std::memory_order_acquire)) out.aux_bytes += f->counters();
+             return out;
+         }
+ 
+         /*═══════════════════════════════════════════════════════════════════════
+          * SHAPE ANALYTICS - Chunked In-Order Walk
+          *═══════════════════════════════════════════════════════════════════════
+          * Walks the tree in key order, chunk_nodes nodes per acquisition of
+          * writers_mutex (see walk_chunk()), so on a 100M-key tree no writer
+          * waits behind more than one chunk. Under concurrent writes the
+          * result mixes shapes a few chunks apart; it is exact once writers
+          * are quiescent.
+          *═══════════════════════════════════════════════════════════════════════*/
+         ShapeStats shape_stats(size_t chunk_nodes = 4096) const
+         {
+             ShapeStats out;
+             std::optional<K> resume;
+             bool done;
+             do
+             {
+                 ++out.chunks;
+                 done = walk_chunk(resume, chunk_nodes, LockSite::SHAPE_STATS,
+                                   [&](const NodeT *n, uint32_t depth, uint32_t blacks)
+                                   {
+                                       ++out.nodes;
+                                       out.red_nodes += n->color == Color::RED;
+                                       out.depth_sum += depth;
+                                       out.height = std::max<size_t>(out.height, depth);
+                                       if (out.depth_histogram.size() <= depth)
+                                           out.depth_histogram.resize(depth + 1);
+                                       ++out.depth_histogram[depth];
+                                       if (n->left == NIL || n->right == NIL)
+                                       {
+                                           out.min_leaf_depth = out.min_leaf_depth ? std::min<size_t>(out.min_leaf_depth, depth) : depth;
+                                           out.black_height = std::max<size_t>(out.black_height, blacks);
+                                       }
+                                       return true;
+                                   });
+             } while (!done);
+             return out;
+         }
+ 
+         // Operation counters (see OpStats); all zero unless built with RBT_ENABLE_STATS
+         OpStats op_stats() const
+         {
+ #if defined(RBT_ENABLE_STATS)
+             return op_counters.snapshot();
+ #else
+             return OpStats{};
+ #endif
+         }
+ 
+         void reset_op_stats()
+         {
+ #if defined(RBT_ENABLE_STATS)
+             op_counters.reset();
+ #endif
+         }
+ 
+         // Global-lock wait/hold histograms per LockSite; empty unless built
+         // with RBT_PROFILE_LOCKS
+         std::vector<LockSiteProfile> lock_profile() const
+         {
+ #if defined(RBT_PROFILE_LOCKS)
+             return lock_profiler.snapshot();
+ #else
+             return {};
+ #endif
+         }
+ 
+         void reset_lock_profile()
+         {
+ #if defined(RBT_PROFILE_LOCKS)
+             lock_profiler.reset();
+ #endif
+         }
+ 
+         void dump_lock_profile(std::ostream &os) const
+         {
+ #if defined(RBT_PROFILE_LOCKS)
+             print_lock_profile(os, lock_profile());
+ #else
+             os << "lock profiling disabled (build with -DRBT_PROFILE_LOCKS)\n";
+ #endif
+         }
+ 
+         /*═══════════════════════════════════════════════════════════════════════
+          * NEGATIVE-LOOKUP FILTER - Skip the Descent for Absent Keys
+          *═══════════════════════════════════════════════════════════════════════
+          * enable_negative_filter() builds a CountingBloomFilter over the
+          * current keys; lookup() then returns nullopt without touching the
+          * tree whenever the filter proves the key absent. Every write path
+          * keeps it exact: a new key is added BEFORE its node is linked, an
+          * erased key is removed AFTER its node is unlinked, so the filter
+          * never reports a reachable key as absent.
+          *
+          * BACKGROUND REBUILD: a counting filter does not decay under churn,
+          * but its false-positive rate tracks the live key count it was
+          * sized for (under 1% at the design size, over 10% at twice it). When the
+          * count leaves [design/4, 2·design] - or on rebuild_negative_filter()
+          * - a helper thread:
+          * 1. Under the writer locks: allocates a filter sized for the current
+          *    count, registers it as pending (writers now update both) and
+          *    copies the keys
+          * 2. Without locks: adds the copied keys to the pending filter
+          * 3. Under the writer locks: publishes it; the old filter is freed
+          *    through the epoch reclaimer once no lookup() can still use it
+          *
+          * Call enable_negative_filter() before the tree is shared between
+          * threads. std::hash<K> must agree with Compare's equivalence.
+          *═══════════════════════════════════════════════════════════════════════*/
+         void enable_negative_filter(size_t counters_per_key = 10)
+         {
+             static_assert(FILTERABLE, "enable_negative_filter() needs a std::hash<K>");
+             std::lock_guard<std::mutex> writer_guard(writers_mutex);
+             std::shared_lock<RWLock> hybrid_guard(global_rw_lock);
+             neg_counters_per_key = counters_per_key;
+             neg_keys = 0;
+             for (NodeT *n = root == NIL ? NIL : minimum(root); n != NIL; n = next_node(n))
+                 ++neg_keys;
+             auto *f = new CountingBloomFilter<K>(filter_design_size(), neg_counters_per_key);
+             for (NodeT *n = root == NIL ? NIL : minimum(root); n != NIL; n = next_node(n))
+                 f->add(n->key);
+             delete neg_filter.exchange(f, std::memory_order_release);
+         }
+ 
+         // Starts a background rebuild now; false if disabled or one is running
+         bool rebuild_negative_filter()
+         {
+             std::lock_guard<std::mutex> writer_guard(writers_mutex);
+             std::shared_lock<RWLock> hybrid_guard(global_rw_lock);
+             if (!neg_filter.load(std::memory_order_relaxed) || neg_rebuilding) return false;
+             start_filter_rebuild();
+             return true;
+         }
+ 
+         NegativeFilterStats negative_filter_stats() const
+         {
+             std::lock_guard<std::mutex> writer_guard(writers_mutex);
+             std::shared_lock<RWLock> hybrid_guard(global_rw_lock);
+             NegativeFilterStats out;
+             if (auto *f = neg_filter.load(std::memory_order_relaxed))
+             {
+                 out.enabled = true;
+                 out.keys = neg_keys;
+                 out.design_keys = f->design_keys();
+                 out.estimated_fpr = f->estimated_fpr(neg_keys);
+                 out.rebuilds = neg_rebuilds;
+             }
+             return out;
+         }
+ 
+         /*═══════════════════════════════════════════════════════════════════════
+          * LOOKUP STRATEGY 3: Global Reader-Writer Lock
+          *═══════════════════════════════════════════════════════════════════════
+          * APPROACH: Use std::shared_mutex for coarse-grained reader-writer sync
+          *
+          * CONCURRENCY MODEL:
+          * - Readers: Acquire shared_lock (multiple readers concurrent)
+          * - Writers: Acquire unique_lock (exclusive access)
+          * - No per-node locking during traversal
+          *
+          * ADVANTAGES:
+          * ✅ Excellent reader parallelism
+          * ✅ Simple implementation
+          * ✅ No deadlock concerns
+          * ✅ Low overhead per operation
+          *
+          * DISADVANTAGES:
+          * ❌ Readers can starve writers (std::shared_mutex issue)
+          *    → instantiate with RWLock = PhaseFairRWLock to bound writer wait
+          * ❌ Less fine-grained than lock coupling
+          *
+          * BEST FOR: Read-dominated workloads with infrequent writes
+          *═══════════════════════════════════════════════════════════════════════*/
+         std::optional<V> lookup_hybrid(const K &k) const { return lookup_hybrid<K>(k); }
+ 
+         template <typename Q, KeyArg<Q> = 0>
+         std::optional<V> lookup_hybrid(const Q &k) const
+         {
+             auto global_lock = lock_global_shared(LockSite::LOOKUP_HYBRID);
+             
+             // Simple traversal under global shared lock protection
+             const NodeT *curr = root;
+             size_t depth = 0;
+             while (curr != NIL)
+             {
+                 ++depth;
+                 int c = three_way(k, curr);
+                 if (c < 0)
+                     curr = curr->left;
+                 else if (c > 0)
+                     curr = curr->right;
+                 else
+                 {
+                     count_lookup(depth);
+                     return curr->val;
+                 }
+             }
+             count_lookup(depth);
+             return std::nullopt;
+         }
+ 
+         /*═══════════════════════════════════════════════════════════════════════
+          * FINGER SEARCH - Position Handles, lookup_from() and insert_hint()
+          *═══════════════════════════════════════════════════════════════════════
+          * Every other operation starts at root. For clustered access (e.g.
+          * time-series ingest of nearly monotonic keys) that is ~2·log2(n)
+          * dependent cache misses spent re-reading the same root path.
+          *
+          * A Position names the node an earlier insert_hint()/lookup_from()
+          * ended at. Handed back in, the search climbs parent links from that
+          * node only until it reaches the lowest ancestor whose key range holds
+          * k, then descends from there: O(log d) for a key d positions away,
+          * O(1) for "just after the last insert".
+          *
+          * SAFETY: a Position is a raw node pointer plus the tree's erase
+          * count when the node was known to be live. If any erase has happened
+          * since, the node may have been freed, so the hint is ignored and the
+          * search starts at root - handles survive insert-only phases, not
+          * churn. Otherwise the climb and descent are optimistic (every node's
+          * version is recorded and revalidated at the end, as in the writers'
+          * optimistic descent), falling back to a root search on conflict.
+          *
+          * A default-constructed Position means "no hint". Positions must only
+          * be used with the tree that produced them.
+          *═══════════════════════════════════════════════════════════════════════*/
+         struct Position
+         {
+             const NodeT *node = nullptr;    // Opaque: never dereference outside the tree
+             uint64_t stamp = 0;             // erase_count when node was known to be live
+         };
+ 
+         // Like lookup(); on return `hint` names where this search ended
+         std::optional<V> lookup_from(Position &hint, const K &k) const
+         {
+             auto pin = reclaimer.pin();
+             uint64_t stamp = erase_count.load(std::memory_order_acquire);   // Before the search
+             Descent d = finger_descend(hint, k);
+             if (!d.valid)
+             {
+                 pin.release();
+                 return lookup(k);           // Contended: plain latch-coupled search
+             }
+             if (d.node == NIL) return std::nullopt;     // Empty tree
+             hint = Position{d.node, stamp};
+             if (d.dir != 0) return std::nullopt;
+             return d.node->val;
+         }
+ 
+         /*═══════════════════════════════════════════════════════════════════════
+          * ORDERED NAVIGATION - Bound Queries and O(1) Extremes
+          *═══════════════════════════════════════════════════════════════════════
+          *   lower_bound(k) / ceiling(k)    smallest key >= k
+          *   upper_bound(k) / successor(k)  smallest key >  k
+          *   floor(k)                       largest key  <= k
+          *   predecessor(k)                 largest key  <  k
+          *
+          * Each is ONE root-to-leaf descent that remembers the last node where
+          * the search turned towards the bound - the answer once it hits NIL.
+          * The plain versions couple node latches exactly like lookup(); the
+          * *_hybrid versions descend under the shared global_rw_lock like
+          * lookup_hybrid(). Results are (key, value) copies; nullopt means no
+          * key satisfies the bound.
+          *
+          * min()/max() read the cached leftmost/rightmost nodes that every
+          * write path keeps current: O(1), no descent. Neither takes a tree
+          * lock, so both are usable alongside either family of writers.
+          *═══════════════════════════════════════════════════════════════════════*/
+         using Entry = std::pair<K, V>;
+ 
+         std::optional<Entry> lower_bound(const K &k) const { return bound_latched(k, Bound::GE); }
+         std::optional<Entry> upper_bound(const K &k) const { return bound_latched(k, Bound::GT); }
+         std::optional<Entry> ceiling(const K &k) const     { return bound_latched(k, Bound::GE); }
+         std::optional<Entry> floor(const K &k) const       { return bound_latched(k, Bound::LE); }
+         std::optional<Entry> successor(const K &k) const   { return bound_latched(k, Bound::GT); }
+         std::optional<Entry> predecessor(const K &k) const { return bound_latched(k, Bound::LT); }
+ 
+         std::optional<Entry> lower_bound_hybrid(const K &k) const { return bound_hybrid(k, Bound::GE); }
+         std::optional<Entry> upper_bound_hybrid(const K &k) const { return bound_hybrid(k, Bound::GT); }
+         std::optional<Entry> ceiling_hybrid(const K &k) const     { return bound_hybrid(k, Bound::GE); }
+         std::optional<Entry> floor_hybrid(const K &k) const       { return bound_hybrid(k, Bound::LE); }
+         std::optional<Entry> successor_hybrid(const K &k) const   { return bound_hybrid(k, Bound::GT); }
+         std::optional<Entry> predecessor_hybrid(const K &k) const { return bound_hybrid(k, Bound::LT); }
+ 
+         template <typename Q, IfTransparent<Q> = 0>
+         std::optional<Entry> lower_bound(const Q &k) const { return bound_latched(k, Bound::GE); }
+         template <typename Q, IfTransparent<Q> = 0>
+         std::optional<Entry> upper_bound(const Q &k) const { return bound_latched(k, Bound::GT); }
+         template <typename Q, IfTransparent<Q> = 0>
+         std::optional<Entry> ceiling(const Q &k) const     { return bound_latched(k, Bound::GE); }
+         template <typename Q, IfTransparent<Q> = 0>
+         std::optional<Entry> floor(const Q &k) const       { return bound_latched(k, Bound::LE); }
+         template <typename Q, IfTransparent<Q> = 0>
+         std::optional<Entry> successor(const Q &k) const   { return bound_latched(k, Bound::GT); }
+         template <typename Q, IfTransparent<Q> = 0>
+         std::optional<Entry> predecessor(const Q &k) const { return bound_latched(k, Bound::LT); }
+ 
+         template <typename Q, IfTransparent<Q> = 0>
+         std::optional<Entry> lower_bound_hybrid(const Q &k) const { return bound_hybrid(k, Bound::GE); }
+         template <typename Q, IfTransparent<Q> = 0>
+         std::optional<Entry> upper_bound_hybrid(const Q &k) const { return bound_hybrid(k, Bound::GT); }
+         template <typename Q, IfTransparent<Q> = 0>
+         std::optional<Entry> ceiling_hybrid(const Q &k) const     { return bound_hybrid(k, Bound::GE); }
+         template <typename Q, IfTransparent<Q> = 0>
+         std::optional<Entry> floor_hybrid(const Q &k) const       { return bound_hybrid(k, Bound::LE); }
+         template <typename Q, IfTransparent<Q> = 0>
+         std::optional<Entry> successor_hybrid(const Q &k) const   { return bound_hybrid(k, Bound::GT); }
+         template <typename Q, IfTransparent<Q> = 0>
+         std::optional<Entry> predecessor_hybrid(const Q &k) const { return bound_hybrid(k, Bound::LT); }
+ 
+         std::optional<Entry> min() const { return extreme(leftmost); }
+         std::optional<Entry> max() const { return extreme(rightmost); }
+ 
+         /*═══════════════════════════════════════════════════════════════════════
+          * INSERT OPERATION - Thread-Safe Tree Insertion
+          *═══════════════════════════════════════════════════════════════════════
+          * CONCURRENCY STRATEGY: Writer serialization via global mutex
+          * - Only one writer can execute at a time
+          * - No per-node locking needed during insertion
           * - Readers using Strategy 2/3 can still proceed during insertion
+          * - The search runs BEFORE writers_mutex is taken (optimistic descent),
+          *   so the critical section is only validate + link + fixup
           *
           * ALGORITHM PHASES:
           * 1. **Search Phase**: Find insertion point using standard BST search
+          *    (optimistically, without the lock; redone under it on conflict)
           * 2. **Link Phase**: Create new node and link into tree structure
           * 3. **Rebalance Phase**: Restore RB-tree properties via rotations/recoloring
           *
@@ -410,292 +2059,1450 @@
           * SPECIAL CASES HANDLED:
           * - Empty tree: New node becomes BLACK root
           * - Duplicate keys: Overwrite existing value (no structural change)
+          *
+          * insert() is insert_hint() without a hint. insert_hint() starts the
+          * optimistic search at `hint` (see FINGER SEARCH) and returns the
+          * Position of k's node for the next call.
+          *
+          * Keys beyond the current minimum or maximum skip the search: the
+          * cached extreme's empty outer slot is the insertion point
+          * (edge_descend), so strictly ascending ingest links in O(1).
+          *═══════════════════════════════════════════════════════════════════════*/
+         void insert(const K &k, const V &v)
+         {
+             insert_hint(Position{}, k, v);
+         }
+ 
+         Position insert_hint(const Position &hint, const K &k, const V &v)
+         {
+             // Create new RED node with NIL children (allocation stays outside the lock)
+             NodeT *z = new NodeT(k, v);  // Default color: RED
+             z->left = z->right = z->parent = NIL;
+ 
+             /*───────────────────────────────────────────────────────────────────
+              * OPTIMISTIC SEARCH PHASE: Descend Without writers_mutex
+              *───────────────────────────────────────────────────────────────────
+              * The epoch pin keeps every node we may touch allocated until the
+              * result has been revalidated under the lock.
+              *───────────────────────────────────────────────────────────────────*/
+             uint64_t clears = clear_count.load(std::memory_order_acquire);
+             auto pin = reclaimer.pin();
+             Descent d = edge_descend(k);
+             if (!d.valid)
+                 d = finger_descend(hint, k);
+ 
+             // SERIALIZATION: Only one writer at a time
+             auto writer_guard = lock_writers(LockSite::INSERT);
+ 
+             NodeT *y = NIL;   // Parent of insertion point
+             int dir = 0;      // Side of y that receives z (<0 left, >0 right)
+ 
+             if (d.valid && still_valid(d, clears))
+             {
+                 // Nothing relinked the node we stopped at: its slot is still ours
+                 pin.release();
+                 if (d.dir == 0)
+                 {
+                     d.node->val = v;   // Overwrite existing value
+                     invalidate_hot(k);
+                     delete z;
+                     return position_of(d.node);
+                 }
+                 y = d.node;
+                 dir = d.dir;
+             }
+             else
+             {
+                 pin.release();
+ 
+                 /*───────────────────────────────────────────────────────────────
+                  * SEARCH PHASE (fallback): Find Insertion Point Under the Lock
+                  *───────────────────────────────────────────────────────────────
+                  * Standard BST search to find where new node should be inserted:
+                  * - y tracks the parent of the insertion point
+                  * - x traverses down the tree following BST ordering
+                  * - Loop terminates when x reaches NIL (insertion point found)
+                  *───────────────────────────────────────────────────────────────*/
+                 NodeT *x = root;  // Current node during traversal
+ 
+                 while (x != NIL)
+                 {
+                     y = x;  // Remember parent
+                     
+                     int c = three_way(k, x);
+                     if (c < 0)
+                     {
+                         x = x->left;           // New key < current → go left
+                         dir = -1;
+                     }
+                     else if (c > 0)
+                     {
+                         x = x->right;          // New key > current → go right
+                         dir = 1;
+                     }
+                     else // DUPLICATE KEY CASE
+                     {
+                         x->val = v;            // Overwrite existing value
+                         invalidate_hot(k);     // Drop the cached old value
+                         delete z;              // Clean up unused node
+                         return position_of(x); // No structural change needed
+                     }
+                 }
+             }
+ 
+             filter_add(k);  // Before z becomes reachable
+             live_nodes.add(1);
+ 
+             /*───────────────────────────────────────────────────────────────────
+              * SPECIAL CASE: Empty Tree
+              *───────────────────────────────────────────────────────────────────
+              * When inserting into empty tree:
+              * 1. New node becomes root
+              * 2. Must be colored BLACK (RB property #2)
+              * 3. No rebalancing needed
+              *───────────────────────────────────────────────────────────────────*/
+             if (y == NIL)
+             {
+                 touch_root();
+                 root = z;
+                 z->color = Color::BLACK;  // Root must be BLACK
+                 extend_extremes(z, NIL, 0);
+                 publish_writes();
+                 return position_of(z);
+             }
+ 
+             /*───────────────────────────────────────────────────────────────────
+              * LINK PHASE: Insert New Node into Tree Structure
+              *───────────────────────────────────────────────────────────────────
+              * Connect new node z as child of y:
+              * - Set z's parent pointer
+              * - Set appropriate child pointer in parent y
+              * - Maintain BST ordering invariant
+              *───────────────────────────────────────────────────────────────────*/
+             z->parent = y;
+             touch(y);
+             if (dir < 0)
+                 y->left = z;               // New key < parent → left child
+             else
+                 y->right = z;              // New key > parent → right child
+             extend_extremes(z, y, dir);
+ 
+             /*───────────────────────────────────────────────────────────────────
+              * REBALANCE PHASE: Restore Red-Black Properties
+              *───────────────────────────────────────────────────────────────────
+              * New RED node may violate RB-tree properties:
+              * - Property #4: RED node with RED parent (red-red violation)
+              * - Property #5: Potentially unbalanced black heights
+              * 
+              * insert_fixup() performs rotations and recoloring to fix violations
+              *───────────────────────────────────────────────────────────────────*/
+             insert_fixup(z);
+             publish_writes();
+             return position_of(z);
+         }
+ 
+         /*═══════════════════════════════════════════════════════════════════════
+          * INSERT HYBRID - Alternative Insert for Strategy 3
+          *═══════════════════════════════════════════════════════════════════════
+          * Uses global_rw_lock instead of writers_mutex for consistency with
+          * lookup_hybrid(). Same algorithm as insert() but different locking.
+          *═══════════════════════════════════════════════════════════════════════*/
+         void insert_hybrid(const K &k, const V &v)
+         {
+             auto writer_lock = lock_global(LockSite::INSERT_HYBRID);
+ 
+             NodeT *z = new NodeT(k, v);
+             z->left = z->right = z->parent = NIL;
+ 
+             if (root == NIL)
+             {
+                 filter_add(k);
+                 live_nodes.add(1);
+                 touch_root();
+                 root = z;
+                 z->color = Color::BLACK;
+                 extend_extremes(z, NIL, 0);
+                 publish_writes();
+                 return;
+             }
+ 
+             NodeT *y = NIL;
+             NodeT *x = root;
+ 
+             while (x != NIL)
+             {
+                 y = x;
+                 int c = three_way(k, x);
+                 if (c < 0)
+                     x = x->left;
+                 else if (c > 0)
+                     x = x->right;
+                 else
+                 {
+                     x->val = v;
+                     invalidate_hot(k);
+                     delete z;
+                     return;
+                 }
+             }
+ 
+             filter_add(k);
+             live_nodes.add(1);
+             z->parent = y;
+             touch(y);
+             int dir = comp(z->key, y->key) ? -1 : 1;
+             if (dir < 0)
+                 y->left = z;
+             else
+                 y->right = z;
+             extend_extremes(z, y, dir);
+ 
+             insert_fixup(z);
+             publish_writes();
+         }
+ 
+         /*═══════════════════════════════════════════════════════════════════════
+          * DELETE/ERASE OPERATION - Thread-Safe Tree Deletion
+          *═══════════════════════════════════════════════════════════════════════
+          * CONCURRENCY: Writer serialization (same as insert)
+          * 
+          * ALGORITHM OVERVIEW (follows CLRS "RB-DELETE"):
+          * 1. **Find Phase**: Locate node to delete
+          * 2. **Splice Phase**: Remove node using BST deletion rules
+          * 3. **Fixup Phase**: Restore RB-tree properties if BLACK node removed
+          *
+          * BST DELETION CASES:
+          * - Node has no children: Simply remove
+          * - Node has one child: Replace with child
+          * - Node has two children: Replace with in-order successor
+          *
+          * RED-BLACK CONSIDERATIONS:
+          * - Removing RED node: No RB-tree violations (easy case)
+          * - Removing BLACK node: May violate black-height property (needs fixup)
+          *
+          * TRANSPLANT OPERATION:
+          * Helper function that replaces subtree u with subtree v, updating
+          * parent pointers to maintain tree structure integrity.
+          *
+          * OPTIMISTIC FIND: The victim is located without writers_mutex. A
+          * validated miss returns false without ever taking the lock; a hit is
+          * accepted under the lock if the victim's version is unchanged (i.e.
+          * it has not been erased meanwhile). Erased nodes are retired to the
+          * epoch reclaimer instead of being freed on the spot.
+          *═══════════════════════════════════════════════════════════════════════*/
+         bool erase(const K &k) { return erase<K>(k); }
+ 
+         template <typename Q, KeyArg<Q> = 0>
+         bool erase(const Q &k)
+         {
+             /*───────────────────────────────────────────────────────────────────
+              * FIND PHASE: Locate Node to Delete
+              *───────────────────────────────────────────────────────────────────
+              * Optimistic BST search first; standard search under the lock if
+              * the optimistic result was invalidated by a concurrent writer.
+              *───────────────────────────────────────────────────────────────────*/
+             uint64_t clears = clear_count.load(std::memory_order_acquire);
+             auto pin = reclaimer.pin();
+             Descent d = optimistic_descend(k);
+             if (d.valid && d.dir != 0)
+                 return false;           // Validated miss: k absent at validation time
+ 
+             auto writer_guard = lock_writers(LockSite::ERASE);
+ 
+             NodeT *z = NIL;
+             if (d.valid && still_valid(d, clears))
+             {
+                 z = d.node;
+             }
+             else
+             {
+                 z = root;
+                 for (int c; z != NIL && (c = three_way(k, z)) != 0;)
+                     z = c < 0 ? z->left : z->right;
+             }
+             pin.release();
+ 
+             if (z == NIL) return false; // Key not found
+ 
+             erase_node(z);
+             invalidate_hot(z->key);     // z stays allocated until collect()
+             filter_remove(z->key);      // After z is unreachable
+             reclaimer.collect();
+             return true;
+         }
+ 
+         /*═══════════════════════════════════════════════════════════════════════
+          * ERASE HYBRID - Alternative Erase for Strategy 3
+          *═══════════════════════════════════════════════════════════════════════
+          * Counterpart of insert_hybrid(): the whole erase runs under
+          * global_rw_lock held exclusively, so lookup_hybrid() readers never
+          * observe a half-spliced tree. Like insert_hybrid(), do not mix it with
+          * insert()/erase() on the same tree -- the two write paths use
+          * different locks and do not exclude each other.
+          *═══════════════════════════════════════════════════════════════════════*/
+         bool erase_hybrid(const K &k) { return erase_hybrid<K>(k); }
+ 
+         template <typename Q, KeyArg<Q> = 0>
+         bool erase_hybrid(const Q &k)
+         {
+             auto writer_lock = lock_global(LockSite::ERASE_HYBRID);
+ 
+             NodeT *z = root;
+             while (z != NIL)
+             {
+                 int c = three_way(k, z);
+                 if (c < 0)
+                     z = z->left;
+                 else if (c > 0)
+                     z = z->right;
+                 else
+                     break;
+             }
+             if (z == NIL) return false;
+ 
+             erase_node(z);
+             invalidate_hot(z->key);     // z stays allocated until collect()
+             filter_remove(z->key);      // After z is unreachable
+             reclaimer.collect();
+             return true;
+         }
+ 
+         /*═══════════════════════════════════════════════════════════════════════
+          * BULK LOAD - O(n) Balanced Build from Sorted Input
+          *═══════════════════════════════════════════════════════════════════════
+          * Builds the tree directly from key/value pairs sorted strictly
+          * ascending under Compare, without any rotations or fixups. Each
+          * subtree's root is the median of its range, so all NIL leaves sit at
+          * depth d or d + 1 where d = floor(log2(n + 1)) is the number of
+          * complete levels. Colouring every node on level d RED (all others
+          * BLACK) then gives every path exactly d black nodes.
+          *
+          * PRECONDITION: the tree is empty. Used by recovery / restore paths
+          * that would otherwise pay n separate inserts under writers_mutex.
+          * Returns false (and leaves the tree untouched) if it is not empty.
+          *═══════════════════════════════════════════════════════════════════════*/
+         bool bulk_load(const std::vector<std::pair<K, V>> &sorted)
+         {
+             std::scoped_lock guard(writers_mutex, global_rw_lock);
+             if (root != NIL) return false;
+             if (sorted.empty()) return true;
+ 
+             int red_depth = 0;                      // floor(log2(n + 1))
+             for (size_t m = sorted.size() + 1; m > 1; m >>= 1)
+                 ++red_depth;
+ 
+             for (const auto &kv : sorted)
+                 filter_add(kv.first);
+             live_nodes.add(static_cast<int64_t>(sorted.size()));
+             touch_root();
+             root = build_balanced(sorted, 0, sorted.size(), 0, red_depth, NIL);
+             leftmost.store(minimum(root), std::memory_order_release);
+             rightmost.store(maximum(root), std::memory_order_release);
+             publish_writes();
+             return true;
+         }
+ 
+         /*═══════════════════════════════════════════════════════════════════════
+          * CLEAR ASYNC - O(1) Detach, Background Free
+          *═══════════════════════════════════════════════════════════════════════
+          * Empties the tree under the writer locks by swinging root to NIL, so
+          * the caller never pays for freeing n nodes. The detached tree is
+          * handed to the reclaimer like an erased node: once every reader
+          * pinned before the detach has left, a background thread frees it
+          * (free_tree over `workers` threads).
+          *
+          * Side effects, as for n erases: Positions go stale, the hot cache is
+          * emptied and the negative filter restarts empty. Descents that began
+          * before the detach fail revalidation (clear_count) and search the
+          * new, empty tree instead.
+          *═══════════════════════════════════════════════════════════════════════*/
+         void clear_async(unsigned workers = 1)
+         {
+             std::scoped_lock guard(writers_mutex, global_rw_lock);
+             if (root == NIL) return;
+ 
+             NodeT *old = root;
+             touch_root();
+             root = NIL;
+             leftmost.store(NIL, std::memory_order_release);
+             rightmost.store(NIL, std::memory_order_release);
+             clear_count.fetch_add(1, std::memory_order_release);
+             erase_count.fetch_add(1, std::memory_order_relaxed);  // Outstanding Positions dangle
+             live_nodes.add(-live_nodes.load());                  // No other writer can run
+             publish_writes();
+ 
+             if (hot_cache) hot_cache->clear();
+             if (auto *f = neg_filter.load(std::memory_order_relaxed))
+             {
+                 auto *fresh = new CountingBloomFilter<K>(FILTER_MIN_KEYS, neg_counters_per_key);
+                 neg_filter.store(fresh, std::memory_order_release);
+                 reclaimer.defer([f] { delete f; });
+                 neg_keys = 0;
+             }
+ 
+             ++teardown_pending;
+             reclaimer.defer([this, old, workers] { teardown_ready.emplace_back(old, workers); });
+             reclaimer.collect();
+             if (!teardown_running)
+             {
+                 teardown_running = true;
+                 if (teardown_worker.joinable()) teardown_worker.join();   // Has exited
+                 teardown_worker = std::thread([this] { run_teardown(); });
+             }
+         }
+ 
+         // Threads the destructor frees the remaining nodes with (default 1)
+         void set_teardown_workers(unsigned workers) { teardown_workers = std::max(1u, workers); }
+ 
+         /*═══════════════════════════════════════════════════════════════════════
+          * FREEZE - Convert to a Read-Only Cache-Friendly Layout
+          *═══════════════════════════════════════════════════════════════════════
+          * Returns an EytzingerTree holding a copy of the current contents
+          * (taken under writers_mutex + shared global_rw_lock, like
+          * save_snapshot()). The tree itself is left untouched and usable.
+          * Intended for read-only serving phases: lookups on the result do no
+          * pointer chasing and take no locks.
+          *═══════════════════════════════════════════════════════════════════════*/
+         EytzingerTree<K, V, Compare> freeze() const
+         {
+             std::vector<K> keys;
+             std::vector<V> vals;
+             collect_in_order(keys, vals);
+             return EytzingerTree<K, V, Compare>(keys, vals, comp);
+         }
+ 
+ 
+         /*═══════════════════════════════════════════════════════════════════════
+          * SAVE SNAPSHOT - Write In-Order Key/Value Arrays for FrozenTree
+          *═══════════════════════════════════════════════════════════════════════
+          * Copies the in-order contents while holding writers_mutex and a
+          * shared global_rw_lock (so neither write path can interleave), then
+          * releases both before any I/O. The file is written to path + ".tmp",
+          * fsync()ed and renamed over path, so readers never observe a partial
+          * snapshot. See SnapshotHeader for the layout; FrozenTree::open()
+          * serves it read-only via mmap. Returns false on any I/O error.
+          *═══════════════════════════════════════════════════════════════════════*/
+ #ifdef RBT_HAVE_MMAP
+         bool save_snapshot(const std::string &path) const
+         {
+             static_assert(std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V>,
+                           "snapshots store keys and values as raw bytes");
+ 
+             std::vector<K> keys;
+             std::vector<V> vals;
+             collect_in_order(keys, vals);
+ 
+             SnapshotHeader h{};
+             std::memcpy(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic));
+             h.version = SNAPSHOT_VERSION;
+             h.byte_order = 0x01020304;
+             h.key_size = sizeof(K);
+             h.val_size = sizeof(V);
+             h.count = keys.size();
+             h.keys_offset = SNAPSHOT_PAGE;
+             h.vals_offset = snapshot_align(h.keys_offset + keys.size() * sizeof(K));
+             h.file_size = h.vals_offset + vals.size() * sizeof(V);
+             h.keys_crc = crc32(keys.data(), keys.size() * sizeof(K));
+             h.vals_crc = crc32(vals.data(), vals.size() * sizeof(V));
+             h.header_crc = crc32(&h, offsetof(SnapshotHeader, header_crc));
+ 
+             const std::string tmp = path + ".tmp";
+             int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+             if (fd < 0) return false;
+ 
+             auto write_at = [fd](const void *data, size_t len, uint64_t off) {
+                 const auto *p = static_cast<const char *>(data);
+                 while (len > 0)
+                 {
+                     ssize_t n = ::pwrite(fd, p, len, static_cast<off_t>(off));
+                     if (n < 0 && errno == EINTR) continue;
+                     if (n <= 0) return false;
+                     p += n;
+                     off += static_cast<uint64_t>(n);
+                     len -= static_cast<size_t>(n);
+                 }
+                 return true;
+             };
+ 
+             bool ok = ::ftruncate(fd, static_cast<off_t>(h.file_size)) == 0 &&   // Zero-fills padding
+                       write_at(&h, sizeof(h), 0) &&
+                       write_at(keys.data(), keys.size() * sizeof(K), h.keys_offset) &&
+                       write_at(vals.data(), vals.size() * sizeof(V), h.vals_offset) &&
+                       ::fsync(fd) == 0;
+             ok = (::close(fd) == 0) && ok;
+             if (ok) ok = std::rename(tmp.c_str(), path.c_str()) == 0;
+             if (!ok) std::remove(tmp.c_str());
+             return ok;
+         }
+ #endif
+ 
+ 
+         /*═══════════════════════════════════════════════════════════════════════
+          * VALIDATION - Verify Red-Black Tree Properties
+          *═══════════════════════════════════════════════════════════════════════
+          * Used for testing and debugging. Checks all RB-tree invariants:
+          * 1. Node colors are valid (RED or BLACK)
+          * 2. Root is BLACK
+          * 3. NIL leaves are BLACK  
+          * 4. No adjacent RED nodes
+          * 5. Equal black heights on all paths
+          * Plus BST ordering property, and size() matching the linked nodes.
           *═══════════════════════════════════════════════════════════════════════*/
-         void insert(const K &k, const V &v)
+         bool validate() const
          {
-             // SERIALIZATION: Only one writer at a time
-             std::unique_lock<std::mutex> writer_guard(writers_mutex);
+             // NIL is never written after construction (see erase_node)
+             if (NIL->color != Color::BLACK || NIL->parent || NIL->left || NIL->right)
+                 return false;
+             int bh = -1;
+             if (!validate_rec(root, 0, bh))
+                 return false;
  
-             // Create new RED node with NIL children
-             NodeT *z = new NodeT(k, v);  // Default color: RED
-             z->left = z->right = z->parent = NIL;
+             // Writers count nodes in the same critical section that links them
+             size_t linked = 0;
+             for (NodeT *n = root == NIL ? NIL : minimum(root); n != NIL; n = next_node(n))
+                 ++linked;
+             return linked == size();
+         }
  
-             /*───────────────────────────────────────────────────────────────────
-              * SPECIAL CASE: Empty Tree
-              *───────────────────────────────────────────────────────────────────
-              * When inserting into empty tree:
-              * 1. New node becomes root
-              * 2. Must be colored BLACK (RB property #2)
-              * 3. No rebalancing needed
-              *───────────────────────────────────────────────────────────────────*/
-             if (root == NIL)
+         /*═══════════════════════════════════════════════════════════════════════
+          * PARALLEL VALIDATION - Subtree Tasks on a Thread Pool
+          *═══════════════════════════════════════════════════════════════════════
+          * Same contract as validate() (writers quiescent), for offline checks
+          * of large trees. The top levels are cut into about 8 tasks per
+          * worker; workers pull tasks from a shared counter, so a thread that
+          * finishes early takes the next subtree. Each task checks its
+          * subtree bottom-up and returns black height, min/max node and node
+          * count; the levels above the cut are then checked from those
+          * summaries. Stricter than validate(): order is checked globally
+          * (max of left subtree < key < min of right subtree) and parent links
+          * are verified.
+          *═══════════════════════════════════════════════════════════════════════*/
+         bool validate_parallel(unsigned workers = std::max(1u, std::thread::hardware_concurrency())) const
+         {
+             if (NIL->color != Color::BLACK || NIL->parent || NIL->left || NIL->right)
+                 return false;
+             if (root != NIL && (root->color != Color::BLACK || root->parent != NIL))
+                 return false;
+ 
+             workers = std::max(1u, workers);
+             unsigned levels = 0;
+             while (levels < 20 && (size_t{1} << levels) < size_t{8} * workers)
+                 ++levels;
+             std::vector<const NodeT *> tasks;
+             collect_frontier(root, workers > 1 ? levels : 0, tasks);
+ 
+             std::vector<SubtreeCheck> results(tasks.size());
+             std::atomic<size_t> next_task{0};
+             auto run = [&]
              {
-                 root = z;
-                 z->color = Color::BLACK;  // Root must be BLACK
-                 return;
+                 size_t i;
+                 while ((i = next_task.fetch_add(1, std::memory_order_relaxed)) < tasks.size())
+                     results[i] = check_subtree(tasks[i]);
+             };
+             std::vector<std::thread> pool;
+             for (unsigned w = 1; w < workers && w < tasks.size(); ++w)
+                 pool.emplace_back(run);
+             run();
+             for (auto &t : pool)
+                 t.join();
+ 
+             size_t next = 0;
+             SubtreeCheck all = merge_frontier(root, workers > 1 ? levels : 0, results, next);
+             return all.ok && all.nodes == size();
+         }
+ 
+         // validate() with writers excluded for the whole traversal (profiled
+         // as LockSite::VALIDATE: every writer stalls behind it meanwhile)
+         bool validate_locked() const
+         {
+             auto writer_guard = lock_writers(LockSite::VALIDATE);
+             return validate();
+         }
+ 
+         /*═══════════════════════════════════════════════════════════════════════
+          * INCREMENTAL VALIDATION - Bounded Slices, Writers Run In Between
+          *═══════════════════════════════════════════════════════════════════════
+          * validate_locked() stalls every writer for a full traversal, which
+          * grows with the tree. validate_slice() checks the next max_nodes nodes
+          * in key order under one walk_chunk() and returns, so the writer
+          * stall is bounded by the slice size. Each visited node is checked
+          * against the tree as it is during its slice:
+          *   - key greater than the previous key checked (order carries over
+          *     from slice to slice through the cursor)
+          *   - children link back to it and are ordered around it
+          *   - no RED node with a RED child
+          *   - every leaf path in the slice has the BLACK count of the
+          *     leftmost path, counted at the start of the slice
+          *   - root BLACK with NIL as parent; NIL untouched (at depth 1)
+          * A pass ends when the walk runs past the largest key; it covers
+          * every node that stayed in the tree for the whole pass.
+          *═══════════════════════════════════════════════════════════════════════*/
+         struct ValidationCursor
+         {
+             std::optional<K> resume;            // Last key checked in this pass
+             uint64_t passes = 0;                // Completed passes
+             uint64_t slices = 0;
+             uint64_t nodes = 0;                 // Nodes checked over all passes
+         };
+ 
+         // False on the first violation found in this slice
+         bool validate_slice(ValidationCursor &cursor, size_t max_nodes = 1024) const
+         {
+             const K *prev = cursor.resume ? &*cursor.resume : nullptr;
+             uint32_t target = 0;                // BLACK count of the leftmost path
+             auto check = [&](const NodeT *n, uint32_t depth, uint32_t blacks)
+             {
+                 if (!target)
+                     for (const NodeT *x = root; x != NIL; x = x->left)
+                         target += x->color == Color::BLACK;
+                 if (prev && !comp(*prev, n->key))
+                     return false;
+                 prev = &n->key;
+                 if (depth == 1 && (n->color != Color::BLACK || n->parent != NIL || NIL->color != Color::BLACK ||
+                                    NIL->parent || NIL->left || NIL->right))
+                     return false;
+                 if (n->left != NIL && (n->left->parent != n || !comp(n->left->key, n->key)))
+                     return false;
+                 if (n->right != NIL && (n->right->parent != n || !comp(n->key, n->right->key)))
+                     return false;
+                 if (n->color == Color::RED && (n->left->color == Color::RED || n->right->color == Color::RED))
+                     return false;
+                 if ((n->left == NIL || n->right == NIL) && blacks != target)
+                     return false;
+                 return true;
+             };
+ 
+             bool ok = true;
+             bool done = walk_chunk(cursor.resume, max_nodes, LockSite::VALIDATE_SLICE,
+                                    [&](const NodeT *n, uint32_t depth, uint32_t blacks)
+                                    {
+                                        ++cursor.nodes;
+                                        return ok = check(n, depth, blacks);
+                                    });
+             ++cursor.slices;
+             if (done)
+             {
+                 cursor.resume.reset();
+                 ++cursor.passes;
              }
+             return ok;
+         }
  
-             /*───────────────────────────────────────────────────────────────────
-              * SEARCH PHASE: Find Insertion Point
-              *───────────────────────────────────────────────────────────────────
-              * Standard BST search to find where new node should be inserted:
-              * - y tracks the parent of the insertion point
-              * - x traverses down the tree following BST ordering
-              * - Loop terminates when x reaches NIL (insertion point found)
-              *───────────────────────────────────────────────────────────────────*/
-             NodeT *y = NIL;   // Parent of insertion point
-             NodeT *x = root;  // Current node during traversal
+     private:
+         /*───────────────────────────────────────────────────────────────────────
+          * Core Data Members
+          *───────────────────────────────────────────────────────────────────────*/
+         NodeT *root;                        // Pointer to tree root (NIL when empty)
+         NodeT *NIL;                         // Shared BLACK sentinel node (read-only)
+         static constexpr std::align_val_t NIL_ALIGN{64};
+         static constexpr std::size_t NIL_BYTES = (sizeof(NodeT) + 63) & ~std::size_t{63};
+         Compare comp;                       // Key comparator (default: std::less<K>)
  
-             while (x != NIL)
+         /*───────────────────────────────────────────────────────────────────────
+          * three_way - One Comparison per Level
+          *───────────────────────────────────────────────────────────────────────
+          * Sign of the comparison of k against key: <0 below, 0 equivalent,
+          * >0 above. Descents branch three ways on it instead of calling
+          * comp(k, key) and then comp(key, k) - two full comparisons per level
+          * for string or composite keys. Chosen at compile time:
+          * 1. Compare::compare(k, key), if the comparator provides one
+          * 2. std::less over std::string / std::string_view keys: the
+          *    char_traits comparison std::less is defined by
+          * 3. C++20, std::less and k <=> key well-formed
+          * 4. Otherwise the two comp() calls
+          *───────────────────────────────────────────────────────────────────────*/
+         template <typename Q>
+         int three_way(const Q &k, const K &key) const
+         {
+             constexpr bool STD_LESS = std::is_same_v<Compare, std::less<K>> || std::is_same_v<Compare, std::less<>>;
+             constexpr bool STRING_KEY = std::is_same_v<K, std::string> || std::is_same_v<K, std::string_view>;
+             if constexpr (has_three_way_compare<Compare, Q, K>::value)
+                 return comp.compare(k, key);
+             else if constexpr (STD_LESS && STRING_KEY && std::is_convertible_v<const Q &, std::string_view>)
+                 return std::string_view(k).compare(std::string_view(key));
+ #if defined(__cpp_lib_three_way_comparison)
+             else if constexpr (STD_LESS && std::three_way_comparable_with<Q, K>)
              {
-                 y = x;  // Remember parent
-                 
-                 if (comp(k, x->key))
-                     x = x->left;           // New key < current → go left
-                 else if (comp(x->key, k))
-                     x = x->right;          // New key > current → go right
-                 else // DUPLICATE KEY CASE
+                 auto c = k <=> key;
+                 return c < 0 ? -1 : (c > 0 ? 1 : 0);
+             }
+ #endif
+             else
+                 return comp(k, key) ? -1 : (comp(key, k) ? 1 : 0);
+         }
+ 
+         // three_way() against a node: settled by the inline prefixes when they differ
+         template <typename Q>
+         int three_way(const Q &k, const NodeT *n) const
+         {
+             if (int c = prefix_order(k, n))
+                 return c;
+             return three_way(k, n->key);
+         }
+ 
+         // ±1 when the inline string prefixes alone order k against n's key, else 0
+         // (prefixes tie, or this tree's keys / comparator have no prefix order)
+         template <typename Q>
+         int prefix_order(const Q &k, const NodeT *n) const
+         {
+             constexpr bool PREFIXED = std::is_same_v<K, std::string> &&
+                                       (std::is_same_v<Compare, std::less<K>> || std::is_same_v<Compare, std::less<>>);
+             if constexpr (PREFIXED && std::is_convertible_v<const Q &, std::string_view>)
+             {
+                 uint64_t kp = string_prefix(std::string_view(k));
+                 return kp == n->prefix ? 0 : (kp < n->prefix ? -1 : 1);
+             }
+             else
+                 return 0;
+         }
+         
+         // Synchronization primitives for different strategies
+         mutable std::mutex writers_mutex;           // Strategy 1 & 2: serialize writers
+         mutable RWLock global_rw_lock;              // Strategy 3: global reader-writer lock
+ 
+ #if defined(RBT_ENABLE_STATS)
+         mutable OpCounters op_counters;
+ #endif
+ 
+         // Instrumentation hook: an empty inline function without RBT_ENABLE_STATS
+         void count([[maybe_unused]] OpEvent e, [[maybe_unused]] uint64_t by = 1) const
+         {
+ #if defined(RBT_ENABLE_STATS)
+             op_counters.add(e, by);
+ #endif
+         }
+ 
+         void count_lookup([[maybe_unused]] size_t depth) const
+         {
+             count(OpEvent::LOOKUP);
+             count(OpEvent::LOOKUP_NODES, depth);
+         }
+ 
+         // Lock m as a Lock; with stats, try first to tell free from contended
+         template <typename Lock, typename M>
+         Lock acquire(M &m, [[maybe_unused]] OpEvent free) const
+         {
+ #if defined(RBT_ENABLE_STATS)
+             Lock lock(m, std::try_to_lock);
+             if (lock.owns_lock())
+             {
+                 count(free);
+             }
+             else
+             {
+                 count(static_cast<OpEvent>(static_cast<size_t>(free) + 1));
+                 lock.lock();
+             }
+             return lock;
+ #else
+             return Lock(m);
+ #endif
+         }
+ 
+ #if defined(RBT_PROFILE_LOCKS)
+         mutable LockProfiler lock_profiler;
+ 
+         template <typename Lock>
+         using Guard = ProfiledLock<Lock>;
+ #else
+         template <typename Lock>
+         using Guard = Lock;
+ #endif
+ 
+         // acquire(), timed for `site` when profiling
+         template <typename Lock, typename M>
+         Guard<Lock> guard(M &m, OpEvent free, [[maybe_unused]] LockSite site) const
+         {
+ #if defined(RBT_PROFILE_LOCKS)
+             auto requested = ProfiledLock<Lock>::Clock::now();
+             return ProfiledLock<Lock>(acquire<Lock>(m, free), lock_profiler, site, requested);
+ #else
+             return acquire<Lock>(m, free);
+ #endif
+         }
+ 
+         Guard<std::unique_lock<std::mutex>> lock_writers(LockSite site) const
+         {
+             return guard<std::unique_lock<std::mutex>>(writers_mutex, OpEvent::WRITERS_FREE, site);
+         }
+ 
+         Guard<std::unique_lock<RWLock>> lock_global(LockSite site) const
+         {
+             return guard<std::unique_lock<RWLock>>(global_rw_lock, OpEvent::GLOBAL_FREE, site);
+         }
+ 
+         Guard<std::shared_lock<RWLock>> lock_global_shared(LockSite site) const
+         {
+             return guard<std::shared_lock<RWLock>>(global_rw_lock, OpEvent::GLOBAL_FREE, site);
+         }
+ 
+         std::shared_lock<std::shared_mutex> latch_shared(const NodeT *n) const
+         {
+             return acquire<std::shared_lock<std::shared_mutex>>(n->rw, OpEvent::LATCH_FREE);
+         }
+ 
+         // Optimistic writer descent state (written only by the lock-holding writer)
+         std::atomic<uint64_t> root_version{0};      // Version of the root pointer itself
+         std::vector<NodeT *> touched;               // Nodes marked odd by this write
+         bool root_touched = false;                  // root_version marked odd by this write
+         mutable EpochReclaimer<NodeT> reclaimer;    // Deferred free of erased nodes
+ 
+         // Optional front cache for lookup() (enable_hot_cache)
+         static constexpr bool HOT_CACHEABLE =
+             std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V> && is_hashable_v<K>;
+         std::unique_ptr<HotKeyCache<K, V, Compare>> hot_cache;
+ 
+         // Called by every write path once k's old value is unreachable in the tree
+         void invalidate_hot(const K &k)
+         {
+             if constexpr (HOT_CACHEABLE)
+             {
+                 if (hot_cache) hot_cache->invalidate(k);
+             }
+         }
+ 
+         // Optional negative-lookup filter (enable_negative_filter); the fields
+         // below are guarded by the writer locks. Keys without a std::hash
+         // compile the filter hooks out.
+         static constexpr bool FILTERABLE = is_hashable_v<K>;
+         static constexpr size_t FILTER_MIN_KEYS = 1024;
+         std::atomic<CountingBloomFilter<K> *> neg_filter{nullptr};
+         CountingBloomFilter<K> *neg_pending = nullptr;  // Being rebuilt: writers update both
+         size_t neg_keys = 0;                            // Live keys
+         size_t neg_counters_per_key = 10;
+         size_t neg_rebuilds = 0;
+         bool neg_rebuilding = false;
+         std::thread neg_rebuilder;
+ 
+         // clear_async() state, guarded by writers_mutex + global_rw_lock, as is the
+         // reclaimer it drives (teardown_workers: owner only)
+         std::vector<std::pair<NodeT *, unsigned>> teardown_ready;  // Detached, unreachable trees
+         size_t teardown_pending = 0;                // Detached trees not yet taken for freeing
+         bool teardown_running = false;
+         std::thread teardown_worker;
+         unsigned teardown_workers = 1;
+         std::atomic<uint64_t> clear_count{0};       // Detaches so far (Descent revalidation)
+ 
+         // Background half of clear_async(): drive the reclaimer until each
+         // detached tree is safe, then free it outside the locks. Both writer
+         // locks, as in clear_async(): the *_hybrid writers retire and collect
+         // under global_rw_lock alone.
+         void run_teardown()
+         {
+             for (;;)
+             {
+                 std::vector<std::pair<NodeT *, unsigned>> ready;
                  {
-                     x->val = v;            // Overwrite existing value
-                     delete z;              // Clean up unused node
-                     return;                // No structural change needed
+                     std::scoped_lock writer_guard(writers_mutex, global_rw_lock);
+                     reclaimer.collect();
+                     ready.swap(teardown_ready);
+                     teardown_pending -= ready.size();
+                     if (ready.empty() && teardown_pending == 0)
+                     {
+                         teardown_running = false;
+                         return;
+                     }
                  }
+                 for (auto &[tree, workers] : ready)
+                     free_tree(tree, workers);
+                 if (ready.empty())
+                     std::this_thread::sleep_for(std::chrono::microseconds(100));  // Readers still pinned
              }
+         }
  
-             /*───────────────────────────────────────────────────────────────────
-              * LINK PHASE: Insert New Node into Tree Structure
-              *───────────────────────────────────────────────────────────────────
-              * Connect new node z as child of y:
-              * - Set z's parent pointer
-              * - Set appropriate child pointer in parent y
-              * - Maintain BST ordering invariant
-              *───────────────────────────────────────────────────────────────────*/
-             z->parent = y;
-             if (comp(z->key, y->key))
-                 y->left = z;               // New key < parent → left child
+         size_t filter_design_size() const
+         {
+             return std::max(FILTER_MIN_KEYS, neg_keys + neg_keys / 2);   // Headroom for growth
+         }
+ 
+         void filter_add([[maybe_unused]] const K &k)
+         {
+             if constexpr (FILTERABLE)
+             {
+                 auto *f = neg_filter.load(std::memory_order_relaxed);
+                 if (!f) return;
+                 f->add(k);
+                 if (neg_pending) neg_pending->add(k);
+                 ++neg_keys;
+                 if (neg_keys > 2 * f->design_keys()) maybe_start_filter_rebuild();
+             }
+         }
+ 
+         void filter_remove([[maybe_unused]] const K &k)
+         {
+             if constexpr (FILTERABLE)
+             {
+                 auto *f = neg_filter.load(std::memory_order_relaxed);
+                 if (!f) return;
+                 f->remove(k);
+                 if (neg_pending) neg_pending->remove(k);
+                 --neg_keys;
+                 if (f->design_keys() > FILTER_MIN_KEYS && neg_keys < f->design_keys() / 4)
+                     maybe_start_filter_rebuild();
+             }
+         }
+ 
+         void maybe_start_filter_rebuild()
+         {
+             if (!neg_rebuilding) start_filter_rebuild();
+         }
+ 
+         // Caller holds the writer lock(s); the previous helper, if any, is done
+         void start_filter_rebuild()
+         {
+             neg_rebuilding = true;
+             if (neg_rebuilder.joinable()) neg_rebuilder.join();
+             neg_rebuilder = std::thread([this] { rebuild_filter(); });
+         }
+ 
+         void rebuild_filter()
+         {
+             CountingBloomFilter<K> *fresh;
+             std::vector<K> keys;
+             {
+                 std::lock_guard<std::mutex> writer_guard(writers_mutex);
+                 std::shared_lock<RWLock> hybrid_guard(global_rw_lock);
+                 fresh = new CountingBloomFilter<K>(filter_design_size(), neg_counters_per_key);
+                 neg_pending = fresh;
+                 keys.reserve(neg_keys);
+                 for (NodeT *n = root == NIL ? NIL : minimum(root); n != NIL; n = next_node(n))
+                     keys.push_back(n->key);
+             }
+ 
+             // Concurrent writers update `fresh` too; counters commute, so an
+             // erase that lands before its key is added here still nets out
+             for (const K &k : keys)
+                 fresh->add(k);
+ 
+             std::lock_guard<std::mutex> writer_guard(writers_mutex);
+             std::shared_lock<RWLock> hybrid_guard(global_rw_lock);
+             CountingBloomFilter<K> *old = neg_filter.exchange(fresh, std::memory_order_release);
+             neg_pending = nullptr;
+             ++neg_rebuilds;
+             neg_rebuilding = false;
+             reclaimer.defer([old] { delete old; });     // lookup() may still be reading it
+             reclaimer.collect();
+         }
+ 
+         std::atomic<uint64_t> erase_count{0};       // Successful erases (Position validity)
+         StripedCounter live_nodes;                  // Linked nodes (size(), memory_stats())
+ 
+         /*───────────────────────────────────────────────────────────────────────
+          * Ordered Navigation Support
+          *───────────────────────────────────────────────────────────────────────
+          * leftmost/rightmost are written only by the lock-holding writer (NIL
+          * when empty) and read lock-free by min()/max() and edge_descend().
+          * A node accepted by a bound becomes the candidate and the search
+          * continues towards k (left for GE/GT, right for LE/LT) looking for a
+          * closer one; a rejected node sends it the other way.
+          *───────────────────────────────────────────────────────────────────────*/
+         std::atomic<NodeT *> leftmost{nullptr};
+         std::atomic<NodeT *> rightmost{nullptr};
+ 
+         enum class Bound { GE, GT, LE, LT };
+ 
+         template <typename Q>
+         bool bound_accepts(Bound b, const NodeT *n, const Q &k) const
+         {
+             if (int c = prefix_order(k, n))        // c < 0: k below n's key
+             {
+                 bool k_below = c < 0;
+                 return (b == Bound::GE || b == Bound::GT) ? k_below : !k_below;
+             }
+             const K &key = n->key;
+             switch (b)
+             {
+             case Bound::GE: return !comp(key, k);
+             case Bound::GT: return comp(k, key);
+             case Bound::LE: return !comp(k, key);
+             default:        return comp(key, k);
+             }
+         }
+ 
+         // Child to visit next from n, given whether n was accepted
+         const NodeT *bound_next(Bound b, const NodeT *n, bool accepted) const
+         {
+             bool lower = (b == Bound::GE || b == Bound::GT);     // Smallest key beyond k
+             return accepted == lower ? n->left : n->right;
+         }
+ 
+         template <typename Q>
+         std::optional<Entry> bound_hybrid(const Q &k, Bound b) const
+         {
+             auto global_lock = lock_global_shared(LockSite::BOUND_HYBRID);
+             const NodeT *best = NIL;
+             for (const NodeT *n = root; n != NIL;)
+             {
+                 bool accepted = bound_accepts(b, n, k);
+                 if (accepted) best = n;
+                 n = bound_next(b, n, accepted);
+             }
+             if (best == NIL) return std::nullopt;
+             return Entry(best->key, best->val);
+         }
+ 
+         // lookup()'s descent, tracking the candidate instead of stopping at k
+         template <typename Q>
+         std::optional<Entry> bound_latched(const Q &k, Bound b) const
+         {
+             auto pin = reclaimer.pin();             // Candidate stays allocated after unlatching
+             if (root == NIL) return std::nullopt;
+ 
+             const NodeT *curr = root;
+             const NodeT *best = NIL;
+             std::shared_lock<std::shared_mutex> curr_lock = latch_shared(curr);
+             for (;;)
+             {
+                 bool accepted = bound_accepts(b, curr, k);
+                 if (accepted) best = curr;
+                 const NodeT *next = bound_next(b, curr, accepted);
+                 if (next == NIL) break;
+                 couple_to(curr, curr_lock, next);
+             }
+             if (best == NIL) return std::nullopt;
+             if (best != curr)
+             {
+                 curr_lock.unlock();                 // One latch at a time, as in lookup()
+                 curr_lock = latch_shared(best);
+             }
+             return Entry(best->key, best->val);
+         }
+ 
+         // Hand-over-hand step from curr (latched) to its child next, with
+         // lookup()'s deadlock-safe ordering
+         void couple_to(const NodeT *&curr, std::shared_lock<std::shared_mutex> &curr_lock,
+                        const NodeT *next) const
+         {
+             if (curr->lock_id < next->lock_id)
+             {
+                 std::shared_lock<std::shared_mutex> next_lock = latch_shared(next);
+                 curr_lock.unlock();
+                 curr_lock = std::move(next_lock);
+             }
              else
-                 y->right = z;              // New key > parent → right child
+             {
+                 OrderedLockGuard<K, V> ordered_lock(const_cast<NodeT *>(curr), const_cast<NodeT *>(next));
+                 curr_lock.unlock();
+                 curr_lock = latch_shared(next);
+             }
+             curr = next;
+         }
  
-             /*───────────────────────────────────────────────────────────────────
-              * REBALANCE PHASE: Restore Red-Black Properties
-              *───────────────────────────────────────────────────────────────────
-              * New RED node may violate RB-tree properties:
-              * - Property #4: RED node with RED parent (red-red violation)
-              * - Property #5: Potentially unbalanced black heights
-              * 
-              * insert_fixup() performs rotations and recoloring to fix violations
-              *───────────────────────────────────────────────────────────────────*/
-             insert_fixup(z);
+         std::optional<Entry> extreme(const std::atomic<NodeT *> &end) const
+         {
+             auto pin = reclaimer.pin();             // A concurrently erased extreme stays allocated
+             const NodeT *n = end.load(std::memory_order_acquire);
+             if (n == NIL) return std::nullopt;
+             std::shared_lock<std::shared_mutex> latch = latch_shared(n);
+             return Entry(n->key, n->val);
+         }
+ 
+         // New leaf z was linked on side dir of y (y == NIL: z is the only node)
+         void extend_extremes(NodeT *z, NodeT *y, int dir)
+         {
+             if (y == NIL || (dir < 0 && y == leftmost.load(std::memory_order_relaxed)))
+                 leftmost.store(z, std::memory_order_release);
+             if (y == NIL || (dir > 0 && y == rightmost.load(std::memory_order_relaxed)))
+                 rightmost.store(z, std::memory_order_release);
+         }
+ 
+         // z is about to be erased (tree still intact)
+         void shrink_extremes(NodeT *z)
+         {
+             if (z == leftmost.load(std::memory_order_relaxed))
+                 leftmost.store(next_node(z), std::memory_order_release);
+             if (z == rightmost.load(std::memory_order_relaxed))
+                 rightmost.store(prev_node(z), std::memory_order_release);
          }
  
+         static constexpr int OPTIMISTIC_ATTEMPTS = 4;     // Restarts before falling back
+         static constexpr int OPTIMISTIC_MAX_DEPTH = 128;  // > 2·log2(2^64): torn-read guard
+ 
          /*═══════════════════════════════════════════════════════════════════════
-          * INSERT HYBRID - Alternative Insert for Strategy 3
+          * TREE DESTRUCTION - Iterative, Optionally Parallel Cleanup
           *═══════════════════════════════════════════════════════════════════════
-          * Uses global_rw_lock instead of writers_mutex for consistency with
-          * lookup_hybrid(). Same algorithm as insert() but different locking.
+          * free_subtree uses no stack at all: while the current node has a left
+          * child, rotate that child up; once it has none, free it and continue
+          * with its right child. Every node is freed after its links were read,
+          * and depth (even of a corrupted, degenerate tree) never matters.
+          *
+          * free_tree peels the top levels breadth-first until there is about
+          * one subtree per worker, then frees the subtrees round-robin on
+          * `workers` threads. Only NIL is shared, and NIL is never written.
           *═══════════════════════════════════════════════════════════════════════*/
-         void insert_hybrid(const K &k, const V &v)
+         void free_subtree(NodeT *n)
          {
-             std::unique_lock<std::shared_mutex> writer_lock(global_rw_lock);
- 
-             NodeT *z = new NodeT(k, v);
-             z->left = z->right = z->parent = NIL;
+             while (n != NIL)
+             {
+                 NodeT *l = n->left;
+                 if (l != NIL)
+                 {
+                     n->left = l->right;         // Rotate l up: n becomes its right child
+                     l->right = n;
+                     n = l;
+                 }
+                 else
+                 {
+                     NodeT *next = n->right;
+                     delete n;
+                     n = next;
+                 }
+             }
+         }
  
-             if (root == NIL)
+         void free_tree(NodeT *n, unsigned workers)
+         {
+             if (workers <= 1)
              {
-                 root = z;
-                 z->color = Color::BLACK;
+                 free_subtree(n);
                  return;
              }
  
-             NodeT *y = NIL;
-             NodeT *x = root;
- 
-             while (x != NIL)
+             std::vector<NodeT *> parts;
+             if (n != NIL) parts.push_back(n);
+             while (!parts.empty() && parts.size() < workers)
              {
-                 y = x;
-                 if (comp(k, x->key))
-                     x = x->left;
-                 else if (comp(x->key, k))
-                     x = x->right;
-                 else
+                 std::vector<NodeT *> below;
+                 for (NodeT *p : parts)
                  {
-                     x->val = v;
-                     delete z;
-                     return;
+                     if (p->left != NIL) below.push_back(p->left);
+                     if (p->right != NIL) below.push_back(p->right);
+                     delete p;
                  }
+                 parts.swap(below);
              }
  
-             z->parent = y;
-             if (comp(z->key, y->key))
-                 y->left = z;
-             else
-                 y->right = z;
+             auto share = [this, &parts, workers](size_t first) {
+                 for (size_t i = first; i < parts.size(); i += workers)
+                     free_subtree(parts[i]);
+             };
+             std::vector<std::thread> pool;
+             for (size_t w = 1; w < workers && w < parts.size(); ++w)
+                 pool.emplace_back(share, w);
+             share(0);
+             for (auto &t : pool)
+                 t.join();
+         }
  
-             insert_fixup(z);
+         // Median-split builder for bulk_load(): [lo, hi) becomes one subtree
+         NodeT *build_balanced(const std::vector<std::pair<K, V>> &sorted, size_t lo, size_t hi,
+                               int depth, int red_depth, NodeT *parent)
+         {
+             if (lo == hi) return NIL;
+             size_t mid = lo + (hi - lo) / 2;
+             NodeT *n = new NodeT(sorted[mid].first, sorted[mid].second,
+                                  depth == red_depth ? Color::RED : Color::BLACK);
+             n->parent = parent;
+             n->left = build_balanced(sorted, lo, mid, depth + 1, red_depth, n);
+             n->right = build_balanced(sorted, mid + 1, hi, depth + 1, red_depth, n);
+             return n;
          }
  
          /*═══════════════════════════════════════════════════════════════════════
-          * DELETE/ERASE OPERATION - Thread-Safe Tree Deletion
+          * OPTIMISTIC DESCENT SUPPORT - Version-Validated Search Outside the Lock
           *═══════════════════════════════════════════════════════════════════════
-          * CONCURRENCY: Writer serialization (same as insert)
-          * 
-          * ALGORITHM OVERVIEW (follows CLRS "RB-DELETE"):
-          * 1. **Find Phase**: Locate node to delete
-          * 2. **Splice Phase**: Remove node using BST deletion rules
-          * 3. **Fixup Phase**: Restore RB-tree properties if BLACK node removed
+          * Writers search for the insertion point / victim WITHOUT writers_mutex
+          * and take the lock only to revalidate and relink. Correctness rests on
+          * one invariant of this implementation:
           *
-          * BST DELETION CASES:
-          * - Node has no children: Simply remove
-          * - Node has one child: Replace with child
-          * - Node has two children: Replace with in-order successor
+          *   A node's key range (the interval its subtree may hold) only ever
+          *   SHRINKS when that node is relinked - and every relink bumps its
+          *   version. Keys are immutable (erase relinks the successor node
+          *   instead of copying keys), links of other nodes only widen ranges.
           *
-          * RED-BLACK CONSIDERATIONS:
-          * - Removing RED node: No RB-tree violations (easy case)
-          * - Removing BLACK node: May violate black-height property (needs fixup)
+          * PROTOCOL (per hop parent p → child c):
+          * 1. Read p.version (even), compare k with p.key, read the child link
+          * 2. Read c.version, then re-read p.version: unchanged ⇒ c really was
+          *    p's child while k ∈ range(p), hence k ∈ range(c) at that instant
+          * 3. Stop at the node holding k, or at the node whose child link is NIL
           *
-          * TRANSPLANT OPERATION:
-          * Helper function that replaces subtree u with subtree v, updating
-          * parent pointers to maintain tree structure integrity.
+          * Under the lock an unchanged version of the final node proves its key
+          * range still contains k and its child slot is still empty, so the
+          * writer can link (or overwrite / erase) without descending again.
+          * Torn reads from concurrent relinks are caught by validation; the
+          * epoch pin keeps every visited node allocated meanwhile.
           *═══════════════════════════════════════════════════════════════════════*/
-         bool erase(const K &k)
+         struct Descent
          {
-             std::unique_lock<std::mutex> writer_guard(writers_mutex);
+             NodeT *node{nullptr};   // Node holding k, or parent of k's empty slot (NIL: empty tree)
+             uint64_t version{0};    // node->version (root_version when empty) when visited
+             int dir{0};             // 0: node holds k, <0: k's slot is node->left, >0: node->right
+             bool valid{false};      // false: gave up, search again under the lock
+         };
  
-             /*───────────────────────────────────────────────────────────────────
-              * FIND PHASE: Locate Node to Delete
-              *───────────────────────────────────────────────────────────────────
-              * Standard BST search to find node z with key k
-              *───────────────────────────────────────────────────────────────────*/
-             NodeT *z = root;
-             while (z != NIL && k != z->key)
-                 z = comp(k, z->key) ? z->left : z->right;
+         // Caller must hold a reclaimer pin
+         template <typename Q>
+         Descent optimistic_descend(const Q &k) const
+         {
+             for (int attempt = 0; attempt < OPTIMISTIC_ATTEMPTS; ++attempt)
+             {
+                 uint64_t rv = root_version.load(std::memory_order_acquire);
+                 if (rv & 1)
+                     continue;                               // Root being replaced
  
-             if (z == NIL) return false; // Key not found
+                 NodeT *n = root;
+                 if (n == NIL)
+                 {
+                     std::atomic_thread_fence(std::memory_order_acquire);
+                     if (root_version.load(std::memory_order_relaxed) == rv)
+                         return {NIL, rv, 1, true};
+                     continue;
+                 }
  
-             /*───────────────────────────────────────────────────────────────────
-              * SPLICE PHASE: Remove Node from Tree Structure
-              *───────────────────────────────────────────────────────────────────
-              * Variables:
-              * - y: Node actually removed from tree (z or its successor)
-              * - x: Node that replaces y in the tree
-              * - y_original: Original color of removed node (determines if fixup needed)
-              *───────────────────────────────────────────────────────────────────*/
-             NodeT *y = z;                    // Node to be removed
-             NodeT *x = nullptr;              // Replacement node
-             Color y_original = y->color;     // Remember original color
+                 uint64_t nv = n->version.load(std::memory_order_acquire);
+                 std::atomic_thread_fence(std::memory_order_acquire);
+                 if ((nv & 1) || root_version.load(std::memory_order_relaxed) != rv)
+                     continue;
  
-             /*───────────────────────────────────────────────────────────────────
-              * CASE 1: Node has at most one child
-              *───────────────────────────────────────────────────────────────────
-              * When z has 0 or 1 children, we can directly replace z with its
-              * child (or NIL if no children). This is the simple case.
-              *───────────────────────────────────────────────────────────────────*/
-             if (z->left == NIL)
-             {
-                 x = z->right;           // Replace z with right child (may be NIL)
-                 transplant(z, z->right);
+                 for (int depth = 0; depth < OPTIMISTIC_MAX_DEPTH; ++depth)
+                 {
+                     int dir = three_way(k, n);
+                     if (dir == 0)
+                         return {n, nv, 0, true};            // Found k
+ 
+                     NodeT *child = dir < 0 ? n->left : n->right;
+                     uint64_t cv = child == NIL ? 0 : child->version.load(std::memory_order_acquire);
+                     std::atomic_thread_fence(std::memory_order_acquire);
+                     if (n->version.load(std::memory_order_relaxed) != nv)
+                         break;                              // n relinked under us: restart
+                     if (child == NIL)
+                         return {n, nv, dir, true};          // k's empty slot
+                     if (cv & 1)
+                         break;                              // Child mid-relink: restart
+                     n = child;
+                     nv = cv;
+                 }
              }
-             else if (z->right == NIL)
+             return {};
+         }
+ 
+         // Position for n; caller holds the writer lock, so no erase can interleave
+         Position position_of(NodeT *n) const
+         {
+             return Position{n, erase_count.load(std::memory_order_relaxed)};
+         }
+ 
+         /*───────────────────────────────────────────────────────────────────────
+          * edge_descend - O(1) Search for Keys Beyond the Current Min / Max
+          *───────────────────────────────────────────────────────────────────────
+          * Monotonic ingest always inserts past an extreme, whose outer child
+          * slot is then the insertion point. Same contract as a Descent from
+          * optimistic_descend(): the extreme's version is read (even) BEFORE
+          * re-checking that it is still the extreme, so an unchanged version
+          * under the lock proves it still is - growing past it, erasing it or
+          * rotating it all touch it. Invalid when k is not beyond either end.
+          * Caller must hold a reclaimer pin.
+          *───────────────────────────────────────────────────────────────────────*/
+         Descent edge_descend(const K &k) const
+         {
+             for (int side : {1, -1})
              {
-                 x = z->left;            // Replace z with left child
-                 transplant(z, z->left);
+                 const std::atomic<NodeT *> &end = side > 0 ? rightmost : leftmost;
+                 NodeT *e = end.load(std::memory_order_acquire);
+                 if (e == NIL)
+                     return {};
+                 if (side > 0 ? !comp(e->key, k) : !comp(k, e->key))
+                     continue;
+                 uint64_t v = e->version.load(std::memory_order_acquire);
+                 if ((v & 1) || end.load(std::memory_order_acquire) != e)
+                     return {};
+                 return {e, v, side, true};
              }
-             /*───────────────────────────────────────────────────────────────────
-              * CASE 2: Node has two children - Use Successor
-              *───────────────────────────────────────────────────────────────────
-              * When z has two children, we cannot simply remove it. Instead:
-              * 1. Find z's in-order successor y (minimum of right subtree)
-              * 2. Replace z's key/value with y's key/value
-              * 3. Remove y from its original position
-              * 
-              * The successor y is guaranteed to have at most one child (right child)
-              * because it's the minimum in its subtree (no left child possible).
-              *───────────────────────────────────────────────────────────────────*/
-             else
+             return {};
+         }
+ 
+         /*───────────────────────────────────────────────────────────────────────
+          * finger_descend - optimistic_descend() Starting From a Position
+          *───────────────────────────────────────────────────────────────────────
+          * CLIMB: from the hint towards the root, remembering for the current
+          * candidate a the nearest ancestor it hangs LEFT of (hi: bounds a's
+          * range from above) and RIGHT of (lo: from below). k >= hi.key or
+          * k <= lo.key means k lies outside a's subtree: that bound becomes the
+          * new candidate. Once both bounds enclose k (or the root is reached),
+          * DESCEND from a exactly like optimistic_descend().
+          *
+          * Parent links are not covered by the child's version (a rotation
+          * re-parents the moved subtree without touching it), so each climbed
+          * link is checked from the parent's side - p->left or p->right must be
+          * the child - and every visited version is revalidated at the end.
+          * All links read were therefore present at that final instant.
+          * Caller must hold a reclaimer pin.
+          *───────────────────────────────────────────────────────────────────────*/
+         Descent finger_descend(const Position &hint, const K &k) const
+         {
+             NodeT *start = const_cast<NodeT *>(hint.node);
+             if (start == nullptr || erase_count.load(std::memory_order_acquire) != hint.stamp)
+                 return optimistic_descend(k);       // No hint, or it may have been freed
+ 
+             struct Seen
              {
-                 y = minimum(z->right);      // Find in-order successor
-                 y_original = y->color;      // Track successor's original color
-                 x = y->right;               // Successor's replacement
+                 NodeT *node;
+                 uint64_t version;
+             };
+             Seen seen[2 * OPTIMISTIC_MAX_DEPTH];
  
-                 if (y->parent == z)
+             for (int attempt = 0; attempt < OPTIMISTIC_ATTEMPTS; ++attempt)
+             {
+                 size_t count = 0;
+                 auto visit = [&](NodeT *n, uint64_t &v) {
+                     v = n->version.load(std::memory_order_acquire);
+                     if ((v & 1) || count == 2 * OPTIMISTIC_MAX_DEPTH)
+                         return false;               // Mid-relink / erased, or torn-read guard
+                     seen[count++] = {n, v};
+                     return true;
+                 };
+ 
+                 uint64_t rv = root_version.load(std::memory_order_acquire);
+                 bool at_root = false;
+                 NodeT *a = start;                   // Candidate subtree root
+                 uint64_t av;
+                 if ((rv & 1) || !visit(a, av))
+                     continue;
+ 
+                 // CLIMB. lo_ok / hi_ok: k is known to lie above a's lower /
+                 // below a's upper range bound (the side of a.key k is on is free)
+                 NodeT *c = a;
+                 int ac = three_way(k, a);
+                 bool lo_ok = ac > 0, hi_ok = ac < 0;
+                 bool ok = true;
+                 while ((lo_ok || hi_ok) && !(lo_ok && hi_ok))   // Neither: k == a.key
                  {
-                     // Successor is z's direct right child
-                     x->parent = y;          // Update parent pointer
+                     NodeT *p = c->parent;
+                     uint64_t pv;
+                     if (p == NIL)
+                     {
+                         ok = (root == c);           // Unbounded side reached the root
+                         at_root = true;
+                         break;
+                     }
+                     if (!visit(p, pv) || (p->left != c && p->right != c))
+                     {
+                         ok = false;
+                         break;
+                     }
+                     if (p->left == c && !hi_ok)     // First left turn: p.key bounds a from above
+                     {
+                         int pc = three_way(k, p);
+                         if (pc < 0)
+                             hi_ok = true;
+                         else
+                         {
+                             a = p;                  // k >= p.key: k is not under a, try p
+                             av = pv;
+                             lo_ok = pc > 0;
+                         }
+                     }
+                     else if (p->right == c && !lo_ok)   // First right turn: bound from below
+                     {
+                         int pc = three_way(k, p);
+                         if (pc > 0)
+                             lo_ok = true;
+                         else
+                         {
+                             a = p;
+                             av = pv;
+                             hi_ok = pc < 0;
+                         }
+                     }
+                     c = p;
                  }
-                 else
+ 
+                 // DESCEND
+                 Descent d;
+                 NodeT *n = a;
+                 uint64_t nv = av;
+                 while (ok)
                  {
-                     // Successor is deeper in right subtree
-                     transplant(y, y->right);    // Move y's right child up
-                     y->right = z->right;        // y inherits z's right subtree
-                     y->right->parent = y;
+                     int dir = three_way(k, n);
+                     NodeT *child = dir < 0 ? n->left : n->right;
+                     if (dir == 0 || child == NIL)
+                     {
+                         d = {n, nv, dir, true};
+                         break;
+                     }
+                     uint64_t cv;
+                     ok = visit(child, cv);
+                     n = child;
+                     nv = cv;
                  }
+                 if (!ok)
+                     continue;
  
-                 // Replace z with y in the tree structure
-                 transplant(z, y);
-                 y->left = z->left;          // y inherits z's left subtree
-                 y->left->parent = y;
-                 y->color = z->color;        // y adopts z's original color
+                 // VALIDATE: every visited node unchanged since it was read
+                 std::atomic_thread_fence(std::memory_order_acquire);
+                 for (size_t i = 0; i < count && ok; ++i)
+                     ok = seen[i].node->version.load(std::memory_order_relaxed) == seen[i].version;
+                 if (ok && at_root)
+                     ok = root_version.load(std::memory_order_relaxed) == rv;
+                 if (ok)
+                     return d;
              }
+             return optimistic_descend(k);
+         }
  
-             delete z;  // Free memory for removed node
+         // Caller holds writers_mutex (so versions are stable and even unless obsolete);
+         // clears: clear_count read before the descent (a detached tree keeps its versions)
+         bool still_valid(const Descent &d, uint64_t clears) const
+         {
+             if (clear_count.load(std::memory_order_relaxed) != clears)
+                 return false;
+             if (d.node == NIL)
+                 return root == NIL && root_version.load(std::memory_order_relaxed) == d.version;
+             return d.node->version.load(std::memory_order_relaxed) == d.version;
+         }
  
-             /*───────────────────────────────────────────────────────────────────
-              * FIXUP PHASE: Restore Red-Black Properties
-              *───────────────────────────────────────────────────────────────────
-              * If we removed a BLACK node, the tree may violate RB-tree property #5
-              * (equal black heights on all root-to-leaf paths). The node x that
-              * replaced the removed BLACK node is treated as having an "extra black"
-              * that must be redistributed or absorbed to restore balance.
-              *───────────────────────────────────────────────────────────────────*/
-             if (y_original == Color::BLACK)
-                 delete_fixup(x);        // Fix double-black violations
+         // Mark n as being relinked (odd version) until publish_writes()
+         void touch(NodeT *n)
+         {
+             if (n == NIL)
+                 return;
+             uint64_t v = n->version.load(std::memory_order_relaxed);
+             if (v & 1)
+                 return;                                     // Already marked by this write
+             n->version.store(v + 1, std::memory_order_relaxed);
+             std::atomic_thread_fence(std::memory_order_release);
+             touched.push_back(n);
+         }
  
-             return true;
+         void touch_root()
+         {
+             if (root_touched)
+                 return;
+             root_version.store(root_version.load(std::memory_order_relaxed) + 1,
+                                std::memory_order_relaxed);
+             std::atomic_thread_fence(std::memory_order_release);
+             root_touched = true;
          }
  
-         /*═══════════════════════════════════════════════════════════════════════
-          * VALIDATION - Verify Red-Black Tree Properties
-          *═══════════════════════════════════════════════════════════════════════
-          * Used for testing and debugging. Checks all RB-tree invariants:
-          * 1. Node colors are valid (RED or BLACK)
-          * 2. Root is BLACK
-          * 3. NIL leaves are BLACK  
-          * 4. No adjacent RED nodes
-          * 5. Equal black heights on all paths
-          * Plus BST ordering property.
-          *═══════════════════════════════════════════════════════════════════════*/
-         bool validate() const
+         // The node (or root pointer) that links to n is about to change that link
+         void touch_parent_link(NodeT *n)
          {
-             int bh = -1;
-             return validate_rec(root, 0, bh);
+             if (n->parent == NIL)
+                 touch_root();
+             else
+                 touch(n->parent);
          }
  
-     private:
-         /*───────────────────────────────────────────────────────────────────────
-          * Core Data Members
-          *───────────────────────────────────────────────────────────────────────*/
-         NodeT *root;                        // Pointer to tree root (NIL when empty)
-         NodeT *NIL;                         // Shared BLACK sentinel node
-         Compare comp;                       // Key comparator (default: std::less<K>)
-         
-         // Synchronization primitives for different strategies
-         mutable std::mutex writers_mutex;           // Strategy 1 & 2: serialize writers
-         mutable std::shared_mutex global_rw_lock;   // Strategy 3: global reader-writer lock
+         // End of a write: every marked node becomes stable again (odd → even)
+         void publish_writes()
+         {
+             for (NodeT *n : touched)
+                 n->version.store(n->version.load(std::memory_order_relaxed) + 1,
+                                  std::memory_order_release);
+             touched.clear();
+             if (root_touched)
+             {
+                 root_version.store(root_version.load(std::memory_order_relaxed) + 1,
+                                    std::memory_order_release);
+                 root_touched = false;
+             }
+         }
  
-         /*═══════════════════════════════════════════════════════════════════════
-          * TREE DESTRUCTION - Recursive Cleanup
-          *═══════════════════════════════════════════════════════════════════════
-          * Post-order traversal ensures children are deleted before parents,
-          * preventing access to deallocated memory during cleanup.
-          *═══════════════════════════════════════════════════════════════════════*/
-         void destroy_rec(NodeT *n)
+         // Erased node: stays odd (obsolete) forever and is freed by the reclaimer
+         void retire(NodeT *n)
          {
-             if (n == NIL) return;           // Base case: reached sentinel
-             
-             destroy_rec(n->left);           // Delete left subtree first
-             destroy_rec(n->right);          // Delete right subtree second  
-             delete n;                       // Delete current node last
+             touched.erase(std::remove(touched.begin(), touched.end(), n), touched.end());
+             reclaimer.retire(n);
          }
  
          /*═══════════════════════════════════════════════════════════════════════
@@ -745,8 +3552,14 @@
           *───────────────────────────────────────────────────────────────────────*/
          void left_rotate(NodeT *x)
          {
+             count(OpEvent::LEFT_ROTATE);
              NodeT *y = x->right;            // y will move up to x's position
  
+             // Both rotated nodes change key range; x's parent changes a child link
+             touch(x);
+             touch(y);
+             touch_parent_link(x);
+ 
              /*───────────────────────────────────────────────────────────────────
               * STEP 1: Move y's left subtree to be x's right subtree
               *───────────────────────────────────────────────────────────────────
@@ -790,8 +3603,13 @@
           *───────────────────────────────────────────────────────────────────────*/
          void right_rotate(NodeT *y)
          {
+             count(OpEvent::RIGHT_ROTATE);
              NodeT *x = y->left;             // x will move up to y's position
  
+             touch(x);
+             touch(y);
+             touch_parent_link(y);
+ 
              // Step 1: Move x's right subtree to be y's left subtree
              y->left = x->right;
              if (x->right != NIL)
@@ -853,6 +3671,7 @@
               *───────────────────────────────────────────────────────────────────*/
              while (z->parent->color == Color::RED)
              {
+                 count(OpEvent::INSERT_FIXUP_ITERATION);
                  /*═══════════════════════════════════════════════════════════════
                   * BRANCH 1: z's parent is LEFT child of grandparent
                   *═══════════════════════════════════════════════════════════════
@@ -879,6 +3698,7 @@
                       *───────────────────────────────────────────────────────────*/
                      if (y->color == Color::RED)
                      {
+                         count(OpEvent::INSERT_CASE_1);
                          z->parent->color = Color::BLACK;           // Parent: RED → BLACK
                          y->color = Color::BLACK;                   // Uncle: RED → BLACK  
                          z->parent->parent->color = Color::RED;     // Grandparent: BLACK → RED
@@ -908,6 +3728,7 @@
                           *───────────────────────────────────────────────────────*/
                          if (z == z->parent->right)
                          {
+                             count(OpEvent::INSERT_CASE_2);
                              z = z->parent;          // Move z pointer up
                              left_rotate(z);         // Rotate to straighten path
                          }
@@ -926,51 +3747,153 @@
                           * 
                           * No more red-red violations, tree is balanced.
                           *───────────────────────────────────────────────────────*/
+                         count(OpEvent::INSERT_CASE_3);
                          z->parent->color = Color::BLACK;           // Parent: RED → BLACK
                          z->parent->parent->color = Color::RED;     // Grandparent: BLACK → RED
                          right_rotate(z->parent->parent);           // Final rotation
                      }
                  }
-                 /*═══════════════════════════════════════════════════════════════
-                  * BRANCH 2: z's parent is RIGHT child of grandparent
-                  *═══════════════════════════════════════════════════════════════
-                  * Mirror image of Branch 1. Same logic but with left/right
-                  * directions swapped throughout.
-                  *═══════════════════════════════════════════════════════════════*/
+                 /*═══════════════════════════════════════════════════════════════
+                  * BRANCH 2: z's parent is RIGHT child of grandparent
+                  *═══════════════════════════════════════════════════════════════
+                  * Mirror image of Branch 1. Same logic but with left/right
+                  * directions swapped throughout.
+                  *═══════════════════════════════════════════════════════════════*/
+                 else
+                 {
+                     NodeT *y = z->parent->parent->left; // Uncle on opposite side
+ 
+                     if (y->color == Color::RED)         // Case 1 (mirrored)
+                     {
+                         count(OpEvent::INSERT_CASE_1);
+                         z->parent->color = Color::BLACK;
+                         y->color = Color::BLACK;
+                         z->parent->parent->color = Color::RED;
+                         z = z->parent->parent;
+                     }
+                     else
+                     {
+                         if (z == z->parent->left)       // Case 2 (mirrored)
+                         {
+                             count(OpEvent::INSERT_CASE_2);
+                             z = z->parent;
+                             right_rotate(z);            // Opposite rotation
+                         }
+                         
+                         // Case 3 (mirrored)
+                         count(OpEvent::INSERT_CASE_3);
+                         z->parent->color = Color::BLACK;
+                         z->parent->parent->color = Color::RED;
+                         left_rotate(z->parent->parent); // Opposite rotation
+                     }
+                 }
+             }
+ 
+             /*───────────────────────────────────────────────────────────────────
+              * FINAL STEP: Ensure Root is BLACK
+              *───────────────────────────────────────────────────────────────────
+              * Property #2 requires root to be BLACK. If our recoloring made
+              * the root RED, fix it here. This never violates other properties.
+              *───────────────────────────────────────────────────────────────────*/
+             root->color = Color::BLACK;
+         }
+ 
+         /*═══════════════════════════════════════════════════════════════════════
+          * ERASE NODE - Splice and Rebalance (shared by erase / erase_hybrid)
+          *═══════════════════════════════════════════════════════════════════════
+          * Removes z (already located by the caller, who holds the write lock)
+          * and restores the RB-tree properties. z is retired, not freed.
+          *═══════════════════════════════════════════════════════════════════════*/
+         void erase_node(NodeT *z)
+         {
+             /*───────────────────────────────────────────────────────────────────
+              * SPLICE PHASE: Remove Node from Tree Structure
+              *───────────────────────────────────────────────────────────────────
+              * Variables:
+              * - y: Node actually removed from tree (z or its successor)
+              * - x: Node that replaces y in the tree
+              * - y_original: Original color of removed node (determines if fixup needed)
+              * - x_parent: x's parent after the splice, tracked here because x
+              *   may be NIL and NIL's own parent field is never written
+              *───────────────────────────────────────────────────────────────────*/
+             NodeT *y = z;                    // Node to be removed
+             NodeT *x = nullptr;              // Replacement node
+             NodeT *x_parent = z->parent;     // Parent of x once spliced
+             Color y_original = y->color;     // Remember original color
+             touch(z);                        // Optimistic descents must drop z
+             erase_count.fetch_add(1, std::memory_order_relaxed);   // Outstanding Positions may dangle
+             live_nodes.add(-1);
+             shrink_extremes(z);
+ 
+             /*───────────────────────────────────────────────────────────────────
+              * CASE 1: Node has at most one child
+              *───────────────────────────────────────────────────────────────────
+              * When z has 0 or 1 children, we can directly replace z with its
+              * child (or NIL if no children). This is the simple case.
+              *───────────────────────────────────────────────────────────────────*/
+             if (z->left == NIL)
+             {
+                 x = z->right;           // Replace z with right child (may be NIL)
+                 transplant(z, z->right);
+             }
+             else if (z->right == NIL)
+             {
+                 x = z->left;            // Replace z with left child
+                 transplant(z, z->left);
+             }
+             /*───────────────────────────────────────────────────────────────────
+              * CASE 2: Node has two children - Use Successor
+              *───────────────────────────────────────────────────────────────────
+              * When z has two children, we cannot simply remove it. Instead:
+              * 1. Find z's in-order successor y (minimum of right subtree)
+              * 2. Replace z's key/value with y's key/value
+              * 3. Remove y from its original position
+              * 
+              * The successor y is guaranteed to have at most one child (right child)
+              * because it's the minimum in its subtree (no left child possible).
+              *───────────────────────────────────────────────────────────────────*/
+             else
+             {
+                 y = minimum(z->right);      // Find in-order successor
+                 y_original = y->color;      // Track successor's original color
+                 x = y->right;               // Successor's replacement
+                 touch(y);                   // y is relinked into z's position
+ 
+                 if (y->parent == z)
+                 {
+                     // Successor is z's direct right child: x stays below y
+                     x_parent = y;
+                 }
                  else
                  {
-                     NodeT *y = z->parent->parent->left; // Uncle on opposite side
- 
-                     if (y->color == Color::RED)         // Case 1 (mirrored)
-                     {
-                         z->parent->color = Color::BLACK;
-                         y->color = Color::BLACK;
-                         z->parent->parent->color = Color::RED;
-                         z = z->parent->parent;
-                     }
-                     else
-                     {
-                         if (z == z->parent->left)       // Case 2 (mirrored)
-                         {
-                             z = z->parent;
-                             right_rotate(z);            // Opposite rotation
-                         }
-                         
-                         // Case 3 (mirrored)
-                         z->parent->color = Color::BLACK;
-                         z->parent->parent->color = Color::RED;
-                         left_rotate(z->parent->parent); // Opposite rotation
-                     }
+                     // Successor is deeper in right subtree
+                     x_parent = y->parent;
+                     transplant(y, y->right);    // Move y's right child up
+                     y->right = z->right;        // y inherits z's right subtree
+                     y->right->parent = y;
                  }
+ 
+                 // Replace z with y in the tree structure
+                 transplant(z, y);
+                 y->left = z->left;          // y inherits z's left subtree
+                 y->left->parent = y;
+                 y->color = z->color;        // y adopts z's original color
              }
  
+             retire(z);  // Freed once no optimistic descent can still reach it
+ 
              /*───────────────────────────────────────────────────────────────────
-              * FINAL STEP: Ensure Root is BLACK
+              * FIXUP PHASE: Restore Red-Black Properties
               *───────────────────────────────────────────────────────────────────
-              * Property #2 requires root to be BLACK. If our recoloring made
-              * the root RED, fix it here. This never violates other properties.
+              * If we removed a BLACK node, the tree may violate RB-tree property #5
+              * (equal black heights on all root-to-leaf paths). The node x that
+              * replaced the removed BLACK node is treated as having an "extra black"
+              * that must be redistributed or absorbed to restore balance.
               *───────────────────────────────────────────────────────────────────*/
-             root->color = Color::BLACK;
+             if (y_original == Color::BLACK)
+                 delete_fixup(x, x_parent);  // Fix double-black violations
+ 
+             publish_writes();
          }
  
          /*═══════════════════════════════════════════════════════════════════════
@@ -986,10 +3909,12 @@
           * 2. u is left child: v becomes left child of u's parent  
           * 3. u is right child: v becomes right child of u's parent
           * 
-          * POST-CONDITION: v->parent points to u's former parent
+          * POST-CONDITION: v->parent points to u's former parent (unless v is
+          * NIL, which is left untouched - callers track that parent themselves)
           *═══════════════════════════════════════════════════════════════════════*/
          void transplant(NodeT *u, NodeT *v)
          {
+             touch_parent_link(u);           // u's parent (or root) gets a new child
              if (u->parent == NIL)           // u was root
                  root = v;
              else if (u == u->parent->left)  // u was left child
@@ -997,7 +3922,8 @@
              else                            // u was right child
                  u->parent->right = v;
                  
-             v->parent = u->parent;          // v inherits u's parent
+             if (v != NIL)
+                 v->parent = u->parent;      // v inherits u's parent
          }
  
          /*═══════════════════════════════════════════════════════════════════════
@@ -1016,6 +3942,110 @@
              return x;
          }
  
+         // Consistent in-order copy for save_snapshot() / freeze()
+         void collect_in_order(std::vector<K> &keys, std::vector<V> &vals) const
+         {
+             std::lock_guard<std::mutex> writer_guard(writers_mutex);
+             std::shared_lock<RWLock> hybrid_guard(global_rw_lock);
+             for (NodeT *n = root == NIL ? NIL : minimum(root); n != NIL; n = next_node(n))
+             {
+                 keys.push_back(n->key);
+                 vals.push_back(n->val);
+             }
+         }
+ 
+         // One chunk of a resumable in-order walk (shape_stats(), validate_slice()):
+         // under writers_mutex + global_rw_lock (shared) it re-descends from
+         // the root to the first key > resume, then calls
+         // visit(node, depth, blacks) for up to `budget` nodes in key order,
+         // with depth and BLACK count counted from the root (root = 1). visit
+         // returns false to stop early. resume is left at the last node
+         // visited; returns true once the walk has passed the largest key.
+         template <typename Visit>
+         bool walk_chunk(std::optional<K> &resume, size_t budget, LockSite site, Visit &&visit) const
+         {
+             struct Frame
+             {
+                 const NodeT *n;
+                 uint32_t depth;
+                 uint32_t blacks;
+             };
+             auto writer_guard = lock_writers(site);
+             std::shared_lock<RWLock> hybrid_guard(global_rw_lock);
+ 
+             std::vector<Frame> stack;
+             uint32_t depth = 0, blacks = 0;
+             for (const NodeT *n = root; n != NIL;)
+             {
+                 ++depth;
+                 blacks += n->color == Color::BLACK;
+                 if (!resume || comp(*resume, n->key))
+                 {
+                     stack.push_back({n, depth, blacks});
+                     n = n->left;
+                 }
+                 else
+                     n = n->right;
+             }
+ 
+             const NodeT *last = nullptr;
+             bool stopped = false;
+             for (budget = std::max<size_t>(1, budget); budget && !stack.empty(); --budget)
+             {
+                 Frame f = stack.back();
+                 stack.pop_back();
+                 last = f.n;
+                 if (!visit(f.n, f.depth, f.blacks))
+                 {
+                     stopped = true;
+                     break;
+                 }
+                 uint32_t d = f.depth, b = f.blacks;
+                 for (const NodeT *n = f.n->right; n != NIL; n = n->left)
+                     stack.push_back({n, ++d, b += n->color == Color::BLACK});
+             }
+             if (last)
+                 resume = last->key;
+             return !stopped && stack.empty();
+         }
+ 
+ 
+         // In-order successor via parent links (NIL after the maximum)
+         NodeT *next_node(NodeT *x) const
+         {
+             if (x->right != NIL)
+                 return minimum(x->right);
+             NodeT *p = x->parent;
+             while (p != NIL && x == p->right)
+             {
+                 x = p;
+                 p = p->parent;
+             }
+             return p;
+         }
+ 
+         // In-order predecessor via parent links (NIL before the minimum)
+         NodeT *prev_node(NodeT *x) const
+         {
+             if (x->left != NIL)
+                 return maximum(x->left);
+             NodeT *p = x->parent;
+             while (p != NIL && x == p->left)
+             {
+                 x = p;
+                 p = p->parent;
+             }
+             return p;
+         }
+ 
+         NodeT *maximum(NodeT *x) const
+         {
+             while (x->right != NIL)
+                 x = x->right;
+             return x;
+         }
+ 
+ 
          /*═══════════════════════════════════════════════════════════════════════
           * DELETE FIXUP - Restore Red-Black Properties After Deletion  
           *═══════════════════════════════════════════════════════════════════════
@@ -1054,7 +4084,7 @@
           *    Strategy: Final rotation and recoloring to absorb extra black
           *    Effect: Fixes all violations, algorithm terminates
           *═══════════════════════════════════════════════════════════════════════*/
-         void delete_fixup(NodeT *x)
+         void delete_fixup(NodeT *x, NodeT *x_parent)
          {
              /*───────────────────────────────────────────────────────────────────
               * MAIN FIXUP LOOP
@@ -1065,12 +4095,13 @@
               *───────────────────────────────────────────────────────────────────*/
              while (x != root && x->color == Color::BLACK)
              {
+                 count(OpEvent::DELETE_FIXUP_ITERATION);
                  /*═══════════════════════════════════════════════════════════════
                   * BRANCH 1: x is LEFT child
                   *═══════════════════════════════════════════════════════════════*/
-                 if (x == x->parent->left)
+                 if (x == x_parent->left)
                  {
-                     NodeT *w = x->parent->right; // w = sibling of x
+                     NodeT *w = x_parent->right; // w = sibling of x
  
                      /*───────────────────────────────────────────────────────────
                       * CASE 1: Sibling w is RED
@@ -1088,10 +4119,11 @@
                       *───────────────────────────────────────────────────────────*/
                      if (w->color == Color::RED)
                      {
+                         count(OpEvent::DELETE_CASE_1);
                          w->color = Color::BLACK;        // Sibling: RED → BLACK
-                         x->parent->color = Color::RED;  // Parent: BLACK → RED
-                         left_rotate(x->parent);         // Rotate left around parent
-                         w = x->parent->right;           // Update sibling pointer
+                         x_parent->color = Color::RED;   // Parent: BLACK → RED
+                         left_rotate(x_parent);          // Rotate left around parent
+                         w = x_parent->right;            // Update sibling pointer
                      }
  
                      /*───────────────────────────────────────────────────────────
@@ -1109,8 +4141,10 @@
                       *───────────────────────────────────────────────────────────*/
                      if (w->left->color == Color::BLACK && w->right->color == Color::BLACK)
                      {
+                         count(OpEvent::DELETE_CASE_2);
                          w->color = Color::RED;          // "Remove" black from w
-                         x = x->parent;                  // Move extra black up
+                         x = x_parent;                   // Move extra black up
+                         x_parent = x->parent;
                      }
                      else
                      {
@@ -1130,10 +4164,11 @@
                           *───────────────────────────────────────────────────────*/
                          if (w->right->color == Color::BLACK)
                          {
+                             count(OpEvent::DELETE_CASE_3);
                              w->left->color = Color::BLACK;  // Near nephew: RED → BLACK
                              w->color = Color::RED;           // Sibling: BLACK → RED
                              right_rotate(w);                 // Rotate right around sibling
-                             w = x->parent->right;            // Update sibling pointer
+                             w = x_parent->right;             // Update sibling pointer
                          }
  
                          /*───────────────────────────────────────────────────────
@@ -1150,10 +4185,11 @@
                           * 
                           * Extra black absorbed, algorithm terminates
                           *───────────────────────────────────────────────────────*/
-                         w->color = x->parent->color;     // w inherits parent's color
-                         x->parent->color = Color::BLACK; // Parent becomes BLACK
+                         count(OpEvent::DELETE_CASE_4);
+                         w->color = x_parent->color;      // w inherits parent's color
+                         x_parent->color = Color::BLACK;  // Parent becomes BLACK
                          w->right->color = Color::BLACK;  // Far nephew becomes BLACK
-                         left_rotate(x->parent);          // Final rotation
+                         left_rotate(x_parent);           // Final rotation
                          x = root;                        // Terminate loop
                      }
                  }
@@ -1162,36 +4198,41 @@
                   *═══════════════════════════════════════════════════════════════*/
                  else
                  {
-                     NodeT *w = x->parent->left; // Sibling on left side
+                     NodeT *w = x_parent->left; // Sibling on left side
  
                      if (w->color == Color::RED)         // Case 1 (mirrored)
                      {
+                         count(OpEvent::DELETE_CASE_1);
                          w->color = Color::BLACK;
-                         x->parent->color = Color::RED;
-                         right_rotate(x->parent);        // Opposite rotation
-                         w = x->parent->left;
+                         x_parent->color = Color::RED;
+                         right_rotate(x_parent);         // Opposite rotation
+                         w = x_parent->left;
                      }
  
                      if (w->right->color == Color::BLACK && w->left->color == Color::BLACK)
                      {
+                         count(OpEvent::DELETE_CASE_2);
                          w->color = Color::RED;          // Case 2 (mirrored)
-                         x = x->parent;
+                         x = x_parent;
+                         x_parent = x->parent;
                      }
                      else
                      {
                          if (w->left->color == Color::BLACK) // Case 3 (mirrored)
                          {
+                             count(OpEvent::DELETE_CASE_3);
                              w->right->color = Color::BLACK;
                              w->color = Color::RED;
                              left_rotate(w);             // Opposite rotation
-                             w = x->parent->left;
+                             w = x_parent->left;
                          }
  
                          // Case 4 (mirrored)
-                         w->color = x->parent->color;
-                         x->parent->color = Color::BLACK;
+                         count(OpEvent::DELETE_CASE_4);
+                         w->color = x_parent->color;
+                         x_parent->color = Color::BLACK;
                          w->left->color = Color::BLACK;
-                         right_rotate(x->parent);        // Opposite rotation
+                         right_rotate(x_parent);         // Opposite rotation
                          x = root;
                      }
                  }
@@ -1203,8 +4244,81 @@
               * If loop terminated because x became RED or reached root:
               * - RED + extra black = BLACK (absorb extra black)
               * - Root can have any effective black contribution (absorb extra black)
+              * NIL only gets here as the root of an emptied tree; it is BLACK
+              * already and stays unwritten.
               *───────────────────────────────────────────────────────────────────*/
-             x->color = Color::BLACK;
+             if (x != NIL)
+                 x->color = Color::BLACK;
+         }
+ 
+         /*═══════════════════════════════════════════════════════════════════════
+          * PARALLEL VALIDATION - Subtree Summaries for validate_parallel()
+          *═══════════════════════════════════════════════════════════════════════
+          * Each worker reduces one subtree below the cut to a SubtreeCheck
+          * (validity, black height, min/max node, node count); merge_frontier()
+          * then folds those summaries up through the levels above the cut with
+          * the same combine() step, so every edge is checked exactly once.
+          *═══════════════════════════════════════════════════════════════════════*/
+         // Summary of one subtree for validate_parallel()
+         struct SubtreeCheck
+         {
+             bool ok = true;
+             int black_height = 0;           // BLACK nodes on each path down to NIL
+             const NodeT *min = nullptr;     // Smallest / largest node (nullptr: empty)
+             const NodeT *max = nullptr;
+             size_t nodes = 0;
+         };
+ 
+         // n's summary from its children's: both valid, equal black heights,
+         // ordered around n, linked back to n, no RED-RED edge
+         SubtreeCheck combine(const NodeT *n, const SubtreeCheck &l, const SubtreeCheck &r) const
+         {
+             SubtreeCheck out;
+             out.ok = l.ok && r.ok && l.black_height == r.black_height &&
+                      (!l.max || comp(l.max->key, n->key)) && (!r.min || comp(n->key, r.min->key)) &&
+                      (n->left == NIL || n->left->parent == n) && (n->right == NIL || n->right->parent == n) &&
+                      !(n->color == Color::RED && (n->left->color == Color::RED || n->right->color == Color::RED));
+             out.black_height = l.black_height + (n->color == Color::BLACK);
+             out.min = l.min ? l.min : n;
+             out.max = r.max ? r.max : n;
+             out.nodes = l.nodes + r.nodes + 1;
+             return out;
+         }
+ 
+         SubtreeCheck check_subtree(const NodeT *n) const
+         {
+             if (n == NIL)
+                 return {};
+             SubtreeCheck l = check_subtree(n->left);
+             if (!l.ok)
+                 return l;
+             SubtreeCheck r = check_subtree(n->right);
+             if (!r.ok)
+                 return r;
+             return combine(n, l, r);
+         }
+ 
+         // Subtree roots `levels` below n, left to right (NIL where a path ends early)
+         void collect_frontier(const NodeT *n, unsigned levels, std::vector<const NodeT *> &out) const
+         {
+             if (n == NIL || levels == 0)
+             {
+                 out.push_back(n);
+                 return;
+             }
+             collect_frontier(n->left, levels - 1, out);
+             collect_frontier(n->right, levels - 1, out);
+         }
+ 
+         // Folds the task results back up through the levels above the cut
+         SubtreeCheck merge_frontier(const NodeT *n, unsigned levels, const std::vector<SubtreeCheck> &done,
+                                     size_t &next) const
+         {
+             if (n == NIL || levels == 0)
+                 return done[next++];
+             SubtreeCheck l = merge_frontier(n->left, levels - 1, done, next);
+             SubtreeCheck r = merge_frontier(n->right, levels - 1, done, next);
+             return combine(n, l, r);
          }
  
          /*═══════════════════════════════════════════════════════════════════════
@@ -1273,6 +4387,336 @@
          }
      };
  
+ #ifdef RBT_HAVE_MMAP
+     /*═══════════════════════════════════════════════════════════════════════════
+      * FrozenTree - Zero-Copy Read-Only View of a Snapshot File
+      *═══════════════════════════════════════════════════════════════════════════
+      * open() mmaps a file written by RBTree::save_snapshot() and answers
+      * lookup()/range() by binary search directly over the mapped key array;
+      * nothing is deserialised, so opening costs O(1) regardless of size and
+      * the OS page cache keeps hot pages resident across process restarts.
+      *
+      * VERIFICATION: the header (magic, version, byte order, K/V sizes,
+      * offsets vs. file size, header checksum) is always checked. Pass
+      * verify_data = true to also check the key/value checksums; that reads
+      * every page once and therefore gives up the instant open.
+      *
+      * Immutable after open(), so any number of threads may query it without
+      * locking.
+      *═══════════════════════════════════════════════════════════════════════════*/
+     template <typename K, typename V, typename Compare = std::less<K>>
+     class FrozenTree
+     {
+         static_assert(std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V>,
+                       "snapshots store keys and values as raw bytes");
+ 
+     public:
+         static std::optional<FrozenTree> open(const std::string &path, bool verify_data = false)
+         {
+             int fd = ::open(path.c_str(), O_RDONLY);
+             if (fd < 0) return std::nullopt;
+ 
+             struct stat st{};
+             if (::fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < sizeof(SnapshotHeader))
+             {
+                 ::close(fd);
+                 return std::nullopt;
+             }
+             size_t len = static_cast<size_t>(st.st_size);
+             void *map = ::mmap(nullptr, len, PROT_READ, MAP_SHARED, fd, 0);
+             ::close(fd);                    // The mapping keeps the file alive
+             if (map == MAP_FAILED) return std::nullopt;
+ 
+             FrozenTree t(map, len);
+             if (!t.check_header(verify_data)) return std::nullopt;   // Destructor unmaps
+             return t;
+         }
+ 
+         FrozenTree(FrozenTree &&o) noexcept
+             : map(o.map), map_len(o.map_len), keys(o.keys), vals(o.vals), n(o.n), comp(o.comp)
+         {
+             o.map = nullptr;
+             o.map_len = 0;
+         }
+ 
+         FrozenTree &operator=(FrozenTree &&o) noexcept
+         {
+             if (this != &o)
+             {
+                 unmap();
+                 map = o.map;
+                 map_len = o.map_len;
+                 keys = o.keys;
+                 vals = o.vals;
+                 n = o.n;
+                 comp = o.comp;
+                 o.map = nullptr;
+                 o.map_len = 0;
+             }
+             return *this;
+         }
+ 
+         FrozenTree(const FrozenTree &) = delete;
+         FrozenTree &operator=(const FrozenTree &) = delete;
+ 
+         ~FrozenTree() { unmap(); }
+ 
+         size_t size() const { return n; }
+ 
+         std::optional<V> lookup(const K &k) const
+         {
+             const K *it = std::lower_bound(keys, keys + n, k, comp);
+             if (it == keys + n || comp(k, *it)) return std::nullopt;
+             return vals[it - keys];
+         }
+ 
+         // Visit every pair with lo <= key < hi in ascending order; returns the count
+         template <typename F>
+         size_t range(const K &lo, const K &hi, F &&visit) const
+         {
+             size_t i = static_cast<size_t>(std::lower_bound(keys, keys + n, lo, comp) - keys);
+             size_t start = i;
+             for (; i < n && comp(keys[i], hi); ++i)
+                 visit(keys[i], vals[i]);
+             return i - start;
+         }
+ 
+     private:
+         void *map = nullptr;
+         size_t map_len = 0;
+         const K *keys = nullptr;
+         const V *vals = nullptr;
+         size_t n = 0;
+         Compare comp;
+ 
+         FrozenTree(void *m, size_t len) : map(m), map_len(len) {}
+ 
+         void unmap()
+         {
+             if (map) ::munmap(map, map_len);
+             map = nullptr;
+         }
+ 
+         bool check_header(bool verify_data)
+         {
+             const auto *base = static_cast<const uint8_t *>(map);
+             SnapshotHeader h;
+             std::memcpy(&h, base, sizeof(h));
+ 
+             if (std::memcmp(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic)) != 0 ||
+                 h.version != SNAPSHOT_VERSION || h.byte_order != 0x01020304 ||
+                 h.header_crc != crc32(&h, offsetof(SnapshotHeader, header_crc)) ||
+                 h.key_size != sizeof(K) || h.val_size != sizeof(V))
+                 return false;
+ 
+             // Overflow-safe bounds: both arrays must lie inside the mapping
+             if (h.file_size != map_len || h.count > map_len ||
+                 h.keys_offset % SNAPSHOT_PAGE || h.vals_offset % SNAPSHOT_PAGE ||
+                 h.keys_offset > map_len || h.vals_offset > map_len ||
+                 h.count * sizeof(K) > map_len - h.keys_offset ||
+                 h.count * sizeof(V) > map_len - h.vals_offset)
+                 return false;
+ 
+             if (verify_data &&
+                 (crc32(base + h.keys_offset, h.count * sizeof(K)) != h.keys_crc ||
+                  crc32(base + h.vals_offset, h.count * sizeof(V)) != h.vals_crc))
+                 return false;
+ 
+             keys = reinterpret_cast<const K *>(base + h.keys_offset);
+             vals = reinterpret_cast<const V *>(base + h.vals_offset);
+             n = static_cast<size_t>(h.count);
+             return true;
+         }
+     };
+ #endif // RBT_HAVE_MMAP
+ 
+     /*═══════════════════════════════════════════════════════════════════════════
+      * CacheAlignedAllocator - 64-Byte Aligned Storage for Search Arrays
+      *═══════════════════════════════════════════════════════════════════════════*/
+     template <typename T>
+     struct CacheAlignedAllocator
+     {
+         using value_type = T;
+         static constexpr std::align_val_t ALIGN{64};
+ 
+         CacheAlignedAllocator() = default;
+         template <typename U>
+         CacheAlignedAllocator(const CacheAlignedAllocator<U> &) {}
+ 
+         T *allocate(size_t n) { return static_cast<T *>(::operator new(n * sizeof(T), ALIGN)); }
+         void deallocate(T *p, size_t) { ::operator delete(p, ALIGN); }
+ 
+         template <typename U>
+         bool operator==(const CacheAlignedAllocator<U> &) const { return true; }
+         template <typename U>
+         bool operator!=(const CacheAlignedAllocator<U> &) const { return false; }
+     };
+ 
+     /*═══════════════════════════════════════════════════════════════════════════
+      * EytzingerTree - Implicit BFS-Order Search Tree (RBTree::freeze())
+      *═══════════════════════════════════════════════════════════════════════════
+      * LAYOUT: a complete (B+1)-ary search tree stored level by level in one
+      * array; node i holds keys [i·B, i·B + B) and its children are nodes
+      * i·(B+1) + 1 ... i·(B+1) + B + 1. No pointers are stored at all.
+      *
+      * - Generic keys (or a custom Compare): B = 1, which is the classic
+      *   Eytzinger layout (children 2i+1, 2i+2). The descent is branchless
+      *   (the comparison result is added to the index) and prefetches the
+      *   16 descendants four levels down, which are contiguous.
+      *
+      * - Arithmetic keys under std::less: B = 64 / sizeof(K), i.e. one node
+      *   per cache line. A node is searched by counting keys < x; signed
+      *   32/64-bit keys do this with one/two AVX2 (or SSE2) compares plus a
+      *   movemask popcount, other types with a scalar loop the compiler can
+      *   vectorise. A lookup then costs ~log_(B+1)(n) cache misses instead of
+      *   ~log2(n) for the pointer tree.
+      *
+      *   Unused tail slots of the last node are padded with the maximum key;
+      *   `real` tells padding apart from a genuine maximum key.
+      *
+      * Values live in a parallel array indexed like the keys, so key-only
+      * searches keep the value bytes out of the cache.
+      *═══════════════════════════════════════════════════════════════════════════*/
+     template <typename K, typename V, typename Compare = std::less<K>>
+     class EytzingerTree
+     {
+     public:
+         static constexpr bool WIDE = std::is_arithmetic_v<K> && std::is_same_v<Compare, std::less<K>> &&
+                                      sizeof(K) <= 32;
+         static constexpr size_t B = WIDE ? 64 / sizeof(K) : 1;    // Keys per node
+ 
+         EytzingerTree() = default;
+ 
+         // sorted_keys must be strictly ascending under comp; vals[i] belongs to sorted_keys[i]
+         EytzingerTree(const std::vector<K> &sorted_keys, const std::vector<V> &vals, Compare comp = Compare())
+             : n(sorted_keys.size()), nodes((n + B - 1) / B), comp(comp)
+         {
+             keys.resize(nodes * B, pad_key());
+             values.resize(nodes * B);
+             if constexpr (WIDE) real.assign(nodes * B, false);
+             size_t next = 0;
+             build(0, sorted_keys, vals, next);
+         }
+ 
+         size_t size() const { return n; }
+ 
+         std::optional<V> lookup(const K &x) const
+         {
+             size_t slot = lower_bound_slot(x);
+             if (slot == NONE || comp(x, keys[slot])) return std::nullopt;
+             if constexpr (WIDE)
+                 if (!real[slot]) return std::nullopt;
+             return values[slot];
+         }
+ 
+     private:
+         static constexpr size_t NONE = static_cast<size_t>(-1);
+ 
+         size_t n = 0;                                       // Real keys
+         size_t nodes = 0;                                   // Nodes of B slots
+         std::vector<K, CacheAlignedAllocator<K>> keys;      // BFS order, nodes·B slots
+         std::vector<V> values;                              // Parallel to keys
+         std::vector<bool> real;                             // WIDE only: slot is not padding
+         Compare comp;
+ 
+         static K pad_key()
+         {
+             if constexpr (WIDE) return std::numeric_limits<K>::max();
+             else return K{};
+         }
+ 
+         // In-order fill: child 0, key 0, child 1, key 1, ..., child B
+         void build(size_t node, const std::vector<K> &sk, const std::vector<V> &sv, size_t &next)
+         {
+             if (node >= nodes) return;
+             for (size_t i = 0; i <= B; ++i)
+             {
+                 build(node * (B + 1) + i + 1, sk, sv, next);
+                 if (i < B && next < n)
+                 {
+                     keys[node * B + i] = sk[next];
+                     values[node * B + i] = sv[next];
+                     if constexpr (WIDE) real[node * B + i] = true;
+                     ++next;
+                 }
+             }
+         }
+ 
+         /*───────────────────────────────────────────────────────────────────────
+          * lower_bound_slot - slot of the first key >= x (NONE if all < x)
+          *───────────────────────────────────────────────────────────────────────*/
+         size_t lower_bound_slot(const K &x) const
+         {
+             size_t best = NONE;
+             size_t node = 0;
+             if constexpr (B == 1)
+             {
+                 const K *a = keys.data();
+                 while (node < nodes)
+                 {
+                     // Descendants 4 levels down: 16 contiguous slots from 16·node + 15
+ #if defined(__GNUC__)
+                     __builtin_prefetch(a + std::min(16 * node + 15, nodes - 1));
+ #endif
+                     bool go_right = comp(a[node], x);
+                     best = go_right ? best : node;          // cmov, not a branch
+                     node = 2 * node + 1 + go_right;
+                 }
+             }
+             else
+             {
+                 while (node < nodes)
+                 {
+                     size_t c = count_less(keys.data() + node * B, x);
+                     if (c < B) best = node * B + c;
+                     node = node * (B + 1) + c + 1;
+                 }
+             }
+             return best;
+         }
+ 
+         // Number of keys < x among the B keys of one node (keys are sorted)
+         static size_t count_less(const K *k, const K &x)
+         {
+ #if defined(__AVX2__)
+             if constexpr (std::is_integral_v<K> && std::is_signed_v<K> && sizeof(K) == 4)
+             {
+                 __m256i v = _mm256_set1_epi32(static_cast<int32_t>(x));
+                 __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i *>(k));
+                 __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i *>(k + 8));
+                 unsigned m = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(v, a)))) |
+                              static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(v, b)))) << 8;
+                 return static_cast<size_t>(__builtin_popcount(m));
+             }
+             if constexpr (std::is_integral_v<K> && std::is_signed_v<K> && sizeof(K) == 8)
+             {
+                 __m256i v = _mm256_set1_epi64x(static_cast<int64_t>(x));
+                 __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i *>(k));
+                 __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i *>(k + 4));
+                 unsigned m = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(v, a)))) |
+                              static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(v, b)))) << 4;
+                 return static_cast<size_t>(__builtin_popcount(m));
+             }
+ #elif defined(__SSE2__)
+             if constexpr (std::is_integral_v<K> && std::is_signed_v<K> && sizeof(K) == 4)
+             {
+                 __m128i v = _mm_set1_epi32(static_cast<int32_t>(x));
+                 unsigned m = 0;
+                 for (size_t i = 0; i < B; i += 4)
+                 {
+                     __m128i a = _mm_load_si128(reinterpret_cast<const __m128i *>(k + i));
+                     m |= static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(v, a)))) << i;
+                 }
+                 return static_cast<size_t>(__builtin_popcount(m));
+             }
+ #endif
+             size_t c = 0;
+             for (size_t i = 0; i < B; ++i)
+                 c += k[i] < x;
+             return c;
+         }
+     };
+ 
  } // namespace rbt
  
  /*═══════════════════════════════════════════════════════════════════════════════
@@ -1384,29 +4828,24 @@
      /*───────────────────────────────────────────────────────────────────────
       * Validation Thread - Continuous Correctness Checking
       *───────────────────────────────────────────────────────────────────────
-      * Runs independently, periodically checking tree invariants.
-      * Uses writer_mutex to get consistent snapshot during validation.
+      * Runs independently, checking tree invariants in validate_slice()
+      * slices of 1024 nodes: writers wait behind one slice at a time instead
+      * of a whole-tree validate() under writer_mutex.
       * Any assertion failure indicates a race condition or logic error.
       *───────────────────────────────────────────────────────────────────────*/
      std::thread validator([&] {
-         int validation_count = 0;
+         decltype(tree)::ValidationCursor cursor;
          while (!stop.load(std::memory_order_acquire)) {
-             {
-                 // Acquire writer mutex for atomic snapshot of tree state
-                 std::lock_guard<std::mutex> g(tree.writer_mutex());
-                 
-                 // Verify all red-black tree properties
-                 if (!tree.validate()) {
-                     std::cerr << "❌ VALIDATION FAILED at check #" << validation_count << "\n";
-                     std::abort();
-                 }
-                 validation_count++;
+             // Verify red-black properties for the next slice of keys
+             if (!tree.validate_slice(cursor, 1024)) {
+                 std::cerr << "❌ VALIDATION FAILED in pass #" << cursor.passes << "\n";
+                 std::abort();
              }
-             
+ 
              // Sleep briefly to avoid overwhelming the system
-             std::this_thread::sleep_for(std::chrono::milliseconds(50));
+             std::this_thread::sleep_for(std::chrono::milliseconds(1));
          }
-         std::cout << "  ✔ Validator completed " << validation_count << " checks\n";
+         std::cout << "  ✔ Validator completed " << cursor.passes << " passes (" << cursor.slices << " slices)\n";
      });
  
      /*───────────────────────────────────────────────────────────────────────
@@ -1547,11 +4986,58 @@
       * after the stress test. This gives insight into insert/delete balance.
       *───────────────────────────────────────────────────────────────────────*/
      size_t survivors = 0;
-     for (int k = -NKEYS / 4; k < NKEYS * 5 / 4; ++k) {
+     for (int k = -NKEYS / 4; k <= NKEYS * 5 / 4; ++k) {
          if (tree.lookup_simple(k))
              ++survivors;
      }
  
+     /*═══════════════════════════════════════════════════════════════════════
+      * PHASE 4: Snapshot Round Trip (save_snapshot → FrozenTree::open)
+      *═══════════════════════════════════════════════════════════════════════*/
+ #ifdef RBT_HAVE_MMAP
+     {
+         const std::string snap = "/tmp/rbtree_demo.snap";
+         auto t0 = std::chrono::steady_clock::now();
+         if (!tree.save_snapshot(snap)) {
+             std::cerr << "❌ save_snapshot failed\n";
+             return 1;
+         }
+         auto t1 = std::chrono::steady_clock::now();
+         auto frozen = rbt::FrozenTree<int, int>::open(snap, /*verify_data=*/true);
+         auto t2 = std::chrono::steady_clock::now();
+         if (!frozen || frozen->size() != survivors) {
+             std::cerr << "❌ FrozenTree::open failed or size mismatch\n";
+             return 1;
+         }
+         for (int k = -NKEYS / 4; k <= NKEYS * 5 / 4; ++k) {
+             if (frozen->lookup(k) != tree.lookup_simple(k)) {
+                 std::cerr << "❌ FrozenTree disagrees with tree at key " << k << "\n";
+                 return 1;
+             }
+         }
+         size_t in_range = frozen->range(0, NKEYS / 2, [](int, int) {});
+         std::remove(snap.c_str());
+ 
+         using us = std::chrono::microseconds;
+         std::cout << "  ✔ Snapshot saved in " << std::chrono::duration_cast<us>(t1 - t0).count()
+                   << " µs, mmap-opened in " << std::chrono::duration_cast<us>(t2 - t1).count()
+                   << " µs; " << in_range << " keys in [0, " << NKEYS / 2 << ")\n";
+     }
+ #endif
+ 
+     // Read-only serving layout: freeze() must agree with the live tree
+     {
+         auto frozen = tree.freeze();
+         for (int k = -NKEYS / 4; k <= NKEYS * 5 / 4; ++k) {
+             if (frozen.lookup(k) != tree.lookup_simple(k)) {
+                 std::cerr << "❌ freeze() disagrees with tree at key " << k << "\n";
+                 return 1;
+             }
+         }
+         std::cout << "  ✔ freeze(): " << frozen.size() << " keys in Eytzinger layout ("
+                   << decltype(frozen)::B << " keys per node)\n";
+     }
+ 
      /*═══════════════════════════════════════════════════════════════════════
       * SUCCESS REPORT
       *═══════════════════════════════════════════════════════════════════════*/
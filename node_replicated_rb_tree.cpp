@@ -0,0 +1,448 @@
+/*═══════════════════════════════════════════════════════════════════════════════
+ * NODE-REPLICATED RED-BLACK TREE - NUMA-Aware Replication over a Shared Log
+ *═══════════════════════════════════════════════════════════════════════════════
+ *
+ * OVERVIEW:
+ * Wraps rbt::RBTree (lock_based_rb_tree.cpp) so that every NUMA node owns a
+ * full replica of the tree. Readers only ever touch the replica of their own
+ * node, so a lookup never pulls tree nodes across the socket interconnect.
+ * Writers do not modify any replica directly: they append the operation to a
+ * single shared circular log, and each replica replays the log lazily.
+ *
+ *   writer ──append──▶ ┌───┬───┬───┬───┬───┬───┬───┬───┐ ◀── tail
+ *                      │ 0 │ 1 │ 2 │ 3 │ 4 │ 5 │ 6 │ 7 │  (ring, capacity C)
+ *                      └───┴───┴───┴───┴───┴───┴───┴───┘
+ *                         ▲ applied[1]       ▲ applied[0]
+ *                   replica 1 (node 1)   replica 0 (node 0)
+ *
+ * PROTOCOL:
+ * - Append: under log_mutex a writer reserves index i = tail, stores the
+ *   entry in slot i % C and publishes tail = i + 1. If the slot still holds
+ *   an entry some replica has not applied yet, the writer first replays that
+ *   laggard replica itself (the log never overwrites unapplied entries).
+ * - Replay: one combiner per replica (replay_mutex) applies entries
+ *   [applied, tail) with insert_hybrid()/erase_hybrid(), i.e. each entry is
+ *   applied under the replica's global_rw_lock, so readers never see a
+ *   half-applied operation.
+ * - Read: load tail; if the local replica is behind, replay up to it; then
+ *   lookup_hybrid() on the local replica. Any write that completed before
+ *   the read started is below the loaded tail, hence visible.
+ * - Write result: the replica of the writer's own node computes the result
+ *   of the entry (e.g. whether erase found the key) while replaying it and
+ *   hands it back through the entry. All replicas apply the same sequence,
+ *   so every replica would compute the same answer.
+ *
+ * NUMA PLACEMENT:
+ * Replica nodes are allocated by the threads that replay into them, which
+ * are threads of that replica's node; with the default first-touch policy
+ * the memory of each replica therefore lands on its own node.
+ *
+ * TOPOLOGY SIMULATION:
+ * bind_thread(g) pins the calling thread to replica g for every
+ * NodeReplicatedRBTree, which lets a single-socket box exercise the
+ * multi-replica paths (stale replicas, replay races, laggard help). Unbound
+ * threads use the NUMA node of the CPU they run on (Linux), else replica 0.
+ *
+ * TRADE-OFFS:
+ * + Reads are local and run concurrently with writes on other replicas
+ * - Memory grows with the number of replicas
+ * - Every write is applied once per replica; the log serializes writers
+ *═══════════════════════════════════════════════════════════════════════════════*/
+
+// Build & run the demo:
+// g++ -std=c++17 -O2 -DRBTREE_DEMO node_replicated_rb_tree.cpp -o nr_rbt -pthread
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+// The wrapped tree's own demo main must not be compiled into this TU.
+#pragma push_macro("RBTREE_DEMO")
+#undef RBTREE_DEMO
+#include "lock_based_rb_tree.cpp"
+#pragma pop_macro("RBTREE_DEMO")
+
+namespace rbt
+{
+    /*═══════════════════════════════════════════════════════════════════════════
+     * NUMA TOPOLOGY HELPERS
+     *═══════════════════════════════════════════════════════════════════════════
+     * numa_node_count() parses /sys/devices/system/node/online ("0", "0-1",
+     * "0,2-3", ...). numa_node_of_current_cpu() asks the kernel which node
+     * the calling thread currently runs on. Both fall back to a single node
+     * when the information is unavailable.
+     *═══════════════════════════════════════════════════════════════════════════*/
+    inline size_t numa_node_count()
+    {
+        std::ifstream in("/sys/devices/system/node/online");
+        std::string list;
+        if (!(in >> list)) return 1;
+
+        size_t count = 0;
+        size_t pos = 0;
+        while (pos < list.size())
+        {
+            size_t comma = list.find(',', pos);
+            std::string range = list.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+            size_t dash = range.find('-');
+            if (dash == std::string::npos)
+                count += 1;
+            else
+                count += std::stoul(range.substr(dash + 1)) - std::stoul(range.substr(0, dash)) + 1;
+            if (comma == std::string::npos) break;
+            pos = comma + 1;
+        }
+        return count ? count : 1;
+    }
+
+    inline size_t numa_node_of_current_cpu()
+    {
+#if defined(__linux__) && defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+        unsigned cpu = 0, node = 0;
+        if (getcpu(&cpu, &node) == 0) return node;
+#endif
+        return 0;
+    }
+
+    // Simulated NUMA node of the calling thread (-1: use the real one)
+    inline long &replica_thread_group()
+    {
+        static thread_local long group = -1;
+        return group;
+    }
+
+    /*═══════════════════════════════════════════════════════════════════════════
+     * NODE-REPLICATED TREE
+     *═══════════════════════════════════════════════════════════════════════════
+     * Template parameters are forwarded to the per-replica RBTree. K and V
+     * must be copyable (they are stored in the log by value).
+     *═══════════════════════════════════════════════════════════════════════════*/
+    template <typename K, typename V, typename Compare = std::less<K>,
+              typename RWLock = std::shared_mutex>
+    class NodeReplicatedRBTree
+    {
+    public:
+        static constexpr size_t DEFAULT_LOG_CAPACITY = 1u << 16;
+
+        explicit NodeReplicatedRBTree(size_t num_replicas = numa_node_count(),
+                                      size_t log_capacity = DEFAULT_LOG_CAPACITY)
+            : log(log_capacity ? log_capacity : 1)
+        {
+            if (num_replicas == 0) num_replicas = 1;
+            replicas.reserve(num_replicas);
+            for (size_t i = 0; i < num_replicas; ++i)
+                replicas.emplace_back(std::make_unique<Replica>());
+        }
+
+        NodeReplicatedRBTree(const NodeReplicatedRBTree &) = delete;
+        NodeReplicatedRBTree &operator=(const NodeReplicatedRBTree &) = delete;
+
+        /*───────────────────────────────────────────────────────────────────────
+         * Thread → replica binding (topology simulation)
+         *───────────────────────────────────────────────────────────────────────
+         * bind_thread(g) makes the calling thread behave as if it ran on NUMA
+         * node g (taken modulo the replica count). unbind_thread() returns to
+         * automatic placement by the current CPU's node.
+         *───────────────────────────────────────────────────────────────────────*/
+        static void bind_thread(size_t group) { replica_thread_group() = static_cast<long>(group); }
+        static void unbind_thread() { replica_thread_group() = -1; }
+
+        size_t replica_count() const { return replicas.size(); }
+        size_t log_capacity() const { return log.size(); }
+
+        // Replica the calling thread reads from and replays into
+        size_t local_replica() const
+        {
+            long g = replica_thread_group();
+            size_t node = g >= 0 ? static_cast<size_t>(g) : numa_node_of_current_cpu();
+            return node % replicas.size();
+        }
+
+        /*───────────────────────────────────────────────────────────────────────
+         * Read path: catch the local replica up to the current tail, then read
+         *───────────────────────────────────────────────────────────────────────*/
+        std::optional<V> lookup(const K &k)
+        {
+            Replica &r = *replicas[local_replica()];
+            sync(r, tail.load(std::memory_order_seq_cst));
+            return r.tree.lookup_hybrid(k);
+        }
+
+        /*───────────────────────────────────────────────────────────────────────
+         * Write path: append to the shared log, then replay locally
+         *───────────────────────────────────────────────────────────────────────*/
+        void insert(const K &k, const V &v)
+        {
+            execute(OpType::INSERT, k, v);
+        }
+
+        bool erase(const K &k)
+        {
+            return execute(OpType::ERASE, k, V{});
+        }
+
+        // Bring every replica up to date (e.g. before validation or teardown)
+        void sync_all()
+        {
+            uint64_t t = tail.load(std::memory_order_seq_cst);
+            for (auto &r : replicas)
+                sync(*r, t);
+        }
+
+        // Validate every replica's RB-tree invariants after a full sync
+        bool validate()
+        {
+            sync_all();
+            for (auto &r : replicas)
+            {
+                std::lock_guard<std::mutex> replay_guard(r->replay_mutex);
+                std::shared_lock<RWLock> read_guard(r->tree.global_mutex());
+                if (!r->tree.validate()) return false;
+            }
+            return true;
+        }
+
+        // Direct access to one replica (read-only use; e.g. cross-replica checks)
+        const RBTree<K, V, Compare, RWLock> &replica(size_t i) const { return replicas[i]->tree; }
+
+    private:
+        enum class OpType : uint8_t
+        {
+            INSERT,
+            ERASE
+        };
+
+        struct LogEntry
+        {
+            OpType op = OpType::INSERT;
+            K key{};
+            V val{};
+            size_t origin = 0;                  // Replica that reports the result
+            bool *result = nullptr;             // Writer's slot; valid until it returns
+        };
+
+        // One replica per NUMA node; padded so hot fields never share a line
+        struct alignas(64) Replica
+        {
+            RBTree<K, V, Compare, RWLock> tree;
+            std::mutex replay_mutex;                        // One combiner at a time
+            alignas(64) std::atomic<uint64_t> applied{0};   // Log prefix applied so far
+        };
+
+        std::vector<std::unique_ptr<Replica>> replicas;
+        std::vector<LogEntry> log;                      // Circular operation log
+        std::mutex log_mutex;                           // Serializes appenders
+        alignas(64) std::atomic<uint64_t> tail{0};      // Next log index to fill
+
+        /*───────────────────────────────────────────────────────────────────────
+         * execute - append one operation and wait until it takes effect
+         *───────────────────────────────────────────────────────────────────────*/
+        bool execute(OpType op, const K &k, const V &v)
+        {
+            size_t home = local_replica();
+            bool result = false;
+            uint64_t idx;
+            {
+                std::lock_guard<std::mutex> log_guard(log_mutex);
+                idx = tail.load(std::memory_order_relaxed);
+
+                // Slot idx % C is free once every replica applied idx - C
+                if (idx >= log.size())
+                {
+                    uint64_t needed = idx - log.size() + 1;
+                    for (auto &r : replicas)
+                        if (r->applied.load(std::memory_order_acquire) < needed)
+                            sync(*r, idx);  // Help the laggard; entries < idx are published
+                }
+
+                LogEntry &e = log[idx % log.size()];
+                e.op = op;
+                e.key = k;
+                e.val = v;
+                e.origin = home;
+                e.result = &result;
+                tail.store(idx + 1, std::memory_order_seq_cst);
+            }
+
+            // Whoever replays idx on the home replica fills in result before
+            // publishing applied > idx, which sync() observes with acquire.
+            sync(*replicas[home], idx + 1);
+            return result;
+        }
+
+        /*───────────────────────────────────────────────────────────────────────
+         * sync - replay r up to (at least) log index target
+         *───────────────────────────────────────────────────────────────────────
+         * A replica whose applied index already covers target returns without
+         * locking. Otherwise the combiner applies everything published so far,
+         * which may cover later writers' entries too (they then find their
+         * result already filled in).
+         *───────────────────────────────────────────────────────────────────────*/
+        void sync(Replica &r, uint64_t target)
+        {
+            if (r.applied.load(std::memory_order_acquire) >= target) return;
+
+            std::lock_guard<std::mutex> replay_guard(r.replay_mutex);
+            uint64_t from = r.applied.load(std::memory_order_relaxed);
+            uint64_t to = tail.load(std::memory_order_acquire);
+
+            for (uint64_t i = from; i < to; ++i)
+            {
+                const LogEntry &e = log[i % log.size()];
+                bool result;
+                if (e.op == OpType::INSERT)
+                {
+                    r.tree.insert_hybrid(e.key, e.val);
+                    result = true;
+                }
+                else
+                {
+                    result = r.tree.erase_hybrid(e.key);
+                }
+
+                if (replicas[e.origin].get() == &r)
+                    *e.result = result;
+            }
+            r.applied.store(to, std::memory_order_release);
+        }
+    };
+
+} // namespace rbt
+
+#ifdef RBTREE_DEMO
+/*═══════════════════════════════════════════════════════════════════════════════
+ * DEMO - Simulated Two-Node Topology
+ *═══════════════════════════════════════════════════════════════════════════════
+ * Threads are split into two groups (bound to replica 0 and 1). Writers of
+ * both groups insert/erase random keys while readers look them up. A small
+ * log capacity forces the laggard-help path. At the end every replica is
+ * synced and checked against a single-threaded std::map replay of each
+ * writer's own key range.
+ *═══════════════════════════════════════════════════════════════════════════════*/
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+
+int main()
+{
+    constexpr size_t REPLICAS = 2;
+    constexpr int WRITERS_PER_GROUP = 2;
+    constexpr int READERS_PER_GROUP = 3;
+    constexpr int OPS_PER_WRITER = 20000;
+    constexpr int KEYS_PER_WRITER = 512;
+
+    rbt::NodeReplicatedRBTree<int, int> tree(REPLICAS, 256);
+    std::cout << "NUMA nodes detected: " << rbt::numa_node_count()
+              << ", simulated replicas: " << tree.replica_count()
+              << ", log capacity: " << tree.log_capacity() << "\n";
+
+    std::atomic<bool> stop{false};
+    std::atomic<long> reads{0}, hits{0};
+    std::vector<std::map<int, int>> expected(REPLICAS * WRITERS_PER_GROUP);
+    std::vector<std::thread> threads;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t g = 0; g < REPLICAS; ++g)
+    {
+        for (int w = 0; w < WRITERS_PER_GROUP; ++w)
+        {
+            size_t id = g * WRITERS_PER_GROUP + w;
+            threads.emplace_back([&, g, id] {
+                rbt::NodeReplicatedRBTree<int, int>::bind_thread(g);
+                std::mt19937 rng(static_cast<unsigned>(id) * 7919u + 1);
+                std::uniform_int_distribution<int> key_dist(0, KEYS_PER_WRITER - 1);
+                auto &mine = expected[id];
+                int base = static_cast<int>(id) * KEYS_PER_WRITER; // Disjoint ranges
+                for (int i = 0; i < OPS_PER_WRITER; ++i)
+                {
+                    int k = base + key_dist(rng);
+                    if (rng() % 3)
+                    {
+                        tree.insert(k, i);
+                        mine[k] = i;
+                    }
+                    else
+                    {
+                        bool erased = tree.erase(k);
+                        bool present = mine.erase(k) > 0;
+                        if (erased != present)
+                        {
+                            std::cerr << "erase(" << k << ") returned " << erased
+                                      << ", expected " << present << "\n";
+                            std::abort();
+                        }
+                    }
+                }
+            });
+        }
+        for (int r = 0; r < READERS_PER_GROUP; ++r)
+        {
+            threads.emplace_back([&, g, r] {
+                rbt::NodeReplicatedRBTree<int, int>::bind_thread(g);
+                std::mt19937 rng(static_cast<unsigned>(g * 131 + r));
+                std::uniform_int_distribution<int> key_dist(0, static_cast<int>(REPLICAS * WRITERS_PER_GROUP * KEYS_PER_WRITER) - 1);
+                long local_reads = 0, local_hits = 0;
+                while (!stop.load(std::memory_order_relaxed))
+                {
+                    if (tree.lookup(key_dist(rng))) ++local_hits;
+                    ++local_reads;
+                }
+                reads += local_reads;
+                hits += local_hits;
+            });
+        }
+    }
+
+    for (size_t i = 0; i < threads.size(); ++i)
+    {
+        // Writers were created first within each group; join them before stopping readers
+        bool is_writer = (i % (WRITERS_PER_GROUP + READERS_PER_GROUP)) < WRITERS_PER_GROUP;
+        if (is_writer) threads[i].join();
+    }
+    stop = true;
+    for (size_t i = 0; i < threads.size(); ++i)
+        if (threads[i].joinable()) threads[i].join();
+
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    bool ok = tree.validate();
+    for (size_t rep = 0; rep < tree.replica_count() && ok; ++rep)
+    {
+        const auto &replica = tree.replica(rep);
+        for (size_t id = 0; id < expected.size() && ok; ++id)
+        {
+            int base = static_cast<int>(id) * KEYS_PER_WRITER;
+            for (int k = base; k < base + KEYS_PER_WRITER; ++k)
+            {
+                auto it = expected[id].find(k);
+                auto got = replica.lookup_hybrid(k);
+                bool match = (it == expected[id].end()) ? !got : (got && *got == it->second);
+                if (!match)
+                {
+                    std::cerr << "replica " << rep << " diverges at key " << k << "\n";
+                    ok = false;
+                    break;
+                }
+            }
+        }
+    }
+
+    std::cout << "writes: " << expected.size() * OPS_PER_WRITER
+              << ", reads: " << reads << " (" << hits << " hits)"
+              << ", elapsed: " << secs << " s\n";
+    std::cout << (ok ? "All replicas valid and identical ✔" : "Replica check FAILED ✘") << "\n";
+    return ok ? 0 : 1;
+}
+#endif // RBTREE_DEMO
@@ -0,0 +1,680 @@
+// rbtree_benchmark.cpp
+// Throughput benchmark: RB-tree strategies vs. B+tree vs. frozen Eytzinger tree
+// -------------------------------------------------------------------
+// Build: g++ -std=c++17 -pthread -O3 -march=native rbtree_benchmark.cpp -o rbtree_benchmark
+// Usage: ./rbtree_benchmark [keys=1000000] [threads=hardware_concurrency] [seconds=2]
+//                           [--format=json|csv] [--output=FILE]
+//        --format also writes every engine / YCSB table cell as a record
+//        (JSON Lines or CSV) to FILE, appending, or else to stdout, in which
+//        case the tables move to stderr
+//
+// Phases per engine (int keys drawn uniformly from [0, 2·keys)):
+//   build   - single thread inserts `keys` random keys
+//   lookup  - `threads` threads do random lookups (~50% hits)
+//   mixed   - `threads` threads, 90% lookups / 5% inserts / 5% erases
+//
+// Followed by single-threaded comparisons: finger search on nearly monotonic
+// keys (time-series ingest: insert vs. insert_hint, lookup vs. lookup_from),
+// and floor() vs. emulating it with repeated lookup() probes. Last, string keys
+// probed through std::string_view: lookup(std::string(view)) on a std::less<K>
+// tree vs. lookup(view) on a transparent std::less<> tree, with heap
+// allocations per lookup counted by the replaced global operator new; and key
+// comparisons per lookup with a two-call comparator vs. one offering compare(),
+// and hash-like string ids with vs. without the inline node key prefix.
+// Finally, readers on a small cache-resident tree with and without a writer
+// churning erase/insert: erase never stores into the shared NIL sentinel
+// every reader compares leaf links against, so the churn slows readers only
+// by the nodes it actually relinks. And teardown of a `keys`-node tree: the
+// destructor on one thread and on `threads` workers, vs. clear_async().
+// Then memory_stats(): bytes per node and where they go; shape_stats() as a
+// tree grows; validate() vs. validate_parallel(). The run ends with the YCSB
+// core workloads A-F (ycsb_workload.cpp) on RBTree and BPlusTree.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "lock_based_rb_tree.cpp"
+#include "bplus_tree.cpp"
+#include "ycsb_workload.cpp"
+
+// Heap allocations made by the calling thread (string-key phase)
+static thread_local size_t thread_allocations = 0;
+
+void* operator new(std::size_t n) {
+    thread_allocations++;
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+// noinline: keeps GCC from pairing the inlined free() with `new` expressions
+[[gnu::noinline]] void operator delete(void* p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+struct BenchConfig {
+    size_t keys = 1000000;
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    std::chrono::milliseconds duration{2000};
+};
+
+// Machine-readable copy of the throughput tables: one flat record per table
+// cell, so all tables share a schema
+struct RecordSink {
+    std::string format;                 // Empty (tables only), "json" or "csv"
+    std::ostream* out = nullptr;
+
+    void emit(const BenchConfig& config, const std::string& table, const std::string& row,
+              const std::string& metric, double value) const {
+        if (format.empty()) return;
+        auto quoted = [this](const std::string& s) {
+            std::string q = "\"";
+            for (char c : s) q += c == '"' ? (format == "csv" ? "\"\"" : "\\\"") : std::string(1, c);
+            return q + "\"";
+        };
+        if (format == "json") {
+            *out << "{\"table\":" << quoted(table) << ",\"row\":" << quoted(row) << ",\"metric\":" << quoted(metric)
+                 << ",\"value\":" << value << ",\"keys\":" << config.keys << ",\"threads\":" << config.threads
+                 << ",\"duration_ms\":" << config.duration.count() << "}\n";
+        } else {
+            *out << table << "," << quoted(row) << "," << metric << "," << value << "," << config.keys << ","
+                 << config.threads << "," << config.duration.count() << "\n";
+        }
+    }
+};
+RecordSink records;
+
+struct BenchResult {
+    double build_mops = 0.0;    // Million inserts/sec (single thread)
+    double lookup_mops = 0.0;   // Million lookups/sec (all threads)
+    double mixed_mops = 0.0;    // Million ops/sec (all threads); 0 = not supported
+};
+
+// Uniform operation interface over the engines / strategies being compared
+struct Engine {
+    std::string name;
+    std::function<void(int, int)> insert;
+    std::function<bool(int)> erase;
+    std::function<bool(int)> lookup;
+    std::function<void()> prepare_reads;    // Called after build (e.g. freeze)
+    bool read_only_after_build = false;
+};
+
+// Run op(rng) on `threads` threads for the configured duration; returns Mops/s
+template <typename Op>
+double run_timed(const BenchConfig& config, Op op) {
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> total{0};
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < config.threads; t++) {
+        workers.emplace_back([&, t] {
+            std::mt19937 rng(static_cast<unsigned>(t) * 7919u + 17);
+            size_t ops = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int i = 0; i < 64; i++) op(rng);   // Amortise the stop check
+                ops += 64;
+            }
+            total += ops;
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(config.duration);
+    stop.store(true);
+    for (auto& w : workers) w.join();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return total.load() / secs / 1e6;
+}
+
+BenchResult run_engine(const BenchConfig& config, Engine& e) {
+    BenchResult r;
+    int key_space = static_cast<int>(config.keys * 2);
+
+    std::mt19937 build_rng(42);
+    std::uniform_int_distribution<int> build_dist(0, key_space - 1);
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < config.keys; i++) {
+        e.insert(build_dist(build_rng), static_cast<int>(i));
+    }
+    double build_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    r.build_mops = config.keys / build_secs / 1e6;
+
+    if (e.prepare_reads) e.prepare_reads();
+
+    r.lookup_mops = run_timed(config, [&](std::mt19937& rng) {
+        e.lookup(static_cast<int>(rng() % key_space));
+    });
+
+    if (!e.read_only_after_build) {
+        r.mixed_mops = run_timed(config, [&](std::mt19937& rng) {
+            int key = static_cast<int>(rng() % key_space);
+            unsigned dice = rng() % 100;
+            if (dice < 90) e.lookup(key);
+            else if (dice < 95) e.insert(key, static_cast<int>(dice));
+            else e.erase(key);
+        });
+    }
+    return r;
+}
+
+void print_row(const BenchConfig& config, const std::string& name, const BenchResult& r) {
+    records.emit(config, "engines", name, "build_mops", r.build_mops);
+    records.emit(config, "engines", name, "lookup_mops", r.lookup_mops);
+    if (r.mixed_mops > 0.0) records.emit(config, "engines", name, "mixed_mops", r.mixed_mops);
+    std::cout << std::left << std::setw(30) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(14) << r.build_mops
+              << std::setw(14) << r.lookup_mops;
+    if (r.mixed_mops > 0.0) std::cout << std::setw(14) << r.mixed_mops;
+    else std::cout << std::setw(14) << "n/a";
+    std::cout << "\n";
+}
+
+// Nearly monotonic keys: ascending in blocks of 8, shuffled within each block
+std::vector<int> ingest_keys(size_t n) {
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::mt19937 rng(7);
+    for (size_t i = 0; i + 8 <= n; i += 8) {
+        std::shuffle(keys.begin() + i, keys.begin() + i + 8, rng);
+    }
+    return keys;
+}
+
+template <typename Fn>
+double timed_mops(size_t ops, Fn fn) {
+    auto t0 = std::chrono::steady_clock::now();
+    fn();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return ops / secs / 1e6;
+}
+
+void run_finger_search(const BenchConfig& config) {
+    using Tree = rbt::RBTree<int, int>;
+    std::vector<int> keys = ingest_keys(config.keys);
+
+    Tree plain, hinted;
+    double insert_mops = timed_mops(keys.size(), [&] {
+        for (int k : keys) plain.insert(k, k);
+    });
+    double hint_mops = timed_mops(keys.size(), [&] {
+        Tree::Position pos;
+        for (int k : keys) pos = hinted.insert_hint(pos, k, k);
+    });
+    double lookup_mops = timed_mops(keys.size(), [&] {
+        for (int k : keys) plain.lookup(k);
+    });
+    double from_mops = timed_mops(keys.size(), [&] {
+        Tree::Position pos;
+        for (int k : keys) hinted.lookup_from(pos, k);
+    });
+
+    std::cout << "\n==== Finger Search (nearly monotonic keys, 1 thread) ====\n"
+              << std::fixed << std::setprecision(2)
+              << "insert      " << std::setw(10) << insert_mops << " Mop/s    insert_hint  "
+              << std::setw(10) << hint_mops << " Mop/s\n"
+              << "lookup      " << std::setw(10) << lookup_mops << " Mop/s    lookup_from  "
+              << std::setw(10) << from_mops << " Mop/s\n";
+}
+
+// floor(k) vs. emulating it by probing lookup(k), lookup(k-1), ... on keys spaced 16 apart
+void run_navigation(const BenchConfig& config) {
+    constexpr int GAP = 16;
+    rbt::RBTree<int, int> tree;
+    for (size_t i = 0; i < config.keys; i++) tree.insert(static_cast<int>(i) * GAP, static_cast<int>(i));
+
+    std::mt19937 rng(11);
+    std::vector<int> queries(config.keys);
+    for (int& q : queries) q = static_cast<int>(rng() % (config.keys * GAP));
+
+    double probe_mops = timed_mops(queries.size(), [&] {
+        for (int q : queries) {
+            for (int k = q; k >= 0; k--) {
+                if (tree.lookup(k)) break;
+            }
+        }
+    });
+    double floor_mops = timed_mops(queries.size(), [&] {
+        for (int q : queries) tree.floor(q);
+    });
+    double max_mops = timed_mops(queries.size(), [&] {
+        for (size_t i = 0; i < queries.size(); i++) tree.max();
+    });
+
+    std::cout << "\n==== Ordered Navigation (keys spaced " << GAP << " apart, 1 thread) ====\n"
+              << std::fixed << std::setprecision(2)
+              << "probe lookup(k), lookup(k-1), ...  " << std::setw(10) << probe_mops << " Mop/s\n"
+              << "floor(k)                           " << std::setw(10) << floor_mops << " Mop/s\n"
+              << "max()                              " << std::setw(10) << max_mops << " Mop/s\n";
+}
+
+// Readers on a cache-resident tree, alone and next to one erase/insert writer
+void run_erase_churn(const BenchConfig& config) {
+    constexpr int KEYS = 4096;
+    rbt::RBTree<int, int> tree;
+    for (int i = 0; i < KEYS; i++) tree.insert(i, i);
+
+    BenchConfig readers = config;
+    readers.threads = std::max<size_t>(1, config.threads - 1);
+    auto read = [&](std::mt19937& rng) { tree.lookup(static_cast<int>(rng() % KEYS)); };
+
+    double quiet_mops = run_timed(readers, read);
+
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> churned{0};
+    std::thread writer([&] {
+        std::mt19937 rng(5);
+        size_t ops = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            int k = static_cast<int>(rng() % KEYS);
+            tree.erase(k);
+            tree.insert(k, k);
+            ops += 2;
+        }
+        churned = ops;
+    });
+    auto t0 = std::chrono::steady_clock::now();
+    double churn_mops = run_timed(readers, read);
+    stop = true;
+    writer.join();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::cout << "\n==== Readers vs. Erase Churn (" << KEYS << " keys, " << readers.threads
+              << " reader(s) + 1 writer) ====\n"
+              << std::fixed << std::setprecision(2)
+              << "lookup, no writer                  " << std::setw(10) << quiet_mops << " Mop/s\n"
+              << "lookup, writer erasing/inserting   " << std::setw(10) << churn_mops << " Mop/s\n"
+              << "writer erase+insert                " << std::setw(10) << churned.load() / secs / 1e6
+              << " Mop/s\n";
+}
+
+// Time to drop a populated tree: the destructor frees inline, clear_async()
+// detaches in O(1) and frees on a background thread
+void run_teardown(const BenchConfig& config) {
+    using Tree = rbt::RBTree<int, int>;
+    std::vector<std::pair<int, int>> sorted(config.keys);
+    for (size_t i = 0; i < config.keys; i++) sorted[i] = {static_cast<int>(i), static_cast<int>(i)};
+    auto ms_since = [](std::chrono::steady_clock::time_point t0) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    };
+
+    auto destroy_ms = [&](unsigned workers) {
+        auto tree = std::make_unique<Tree>();
+        tree->bulk_load(sorted);
+        tree->set_teardown_workers(workers);
+        auto t0 = std::chrono::steady_clock::now();
+        tree.reset();
+        return ms_since(t0);
+    };
+    double serial_ms = destroy_ms(1);
+    double parallel_ms = destroy_ms(static_cast<unsigned>(config.threads));
+
+    auto tree = std::make_unique<Tree>();
+    tree->bulk_load(sorted);
+    auto t0 = std::chrono::steady_clock::now();
+    tree->clear_async();
+    double detach_ms = ms_since(t0);
+    tree.reset();                                   // Waits for the background free
+    double drained_ms = ms_since(t0);
+
+    std::cout << "\n==== Teardown (" << config.keys << " nodes) ====\n"
+              << std::fixed << std::setprecision(2)
+              << "~RBTree(), 1 worker                " << std::setw(10) << serial_ms << " ms\n"
+              << std::left << std::setw(35) << "~RBTree(), " + std::to_string(config.threads) + " workers"
+              << std::right << std::setw(10) << parallel_ms << " ms\n"
+              << "clear_async() returns after        " << std::setw(10) << detach_ms << " ms\n"
+              << "  ... background free done after   " << std::setw(10) << drained_ms << " ms\n";
+}
+
+// Keys long enough to defeat the small-string optimisation
+std::string string_key(size_t i) {
+    std::string s = "sensor/eu-west-1/device-";
+    std::string digits = std::to_string(i);
+    return s + std::string(10 - std::min<size_t>(10, digits.size()), '0') + digits;
+}
+
+static volatile size_t result_sink = 0;
+
+// Comparator that counts its calls; the three-way variant also offers compare(),
+// which RBTree descents then call once per level instead of operator() twice
+static thread_local size_t key_comparisons = 0;
+
+struct CountingLess {
+    bool operator()(const std::string& a, const std::string& b) const {
+        key_comparisons++;
+        return a < b;
+    }
+};
+
+struct CountingThreeWay : CountingLess {
+    int compare(const std::string& a, const std::string& b) const {
+        key_comparisons++;
+        return a.compare(b);
+    }
+};
+
+// Same order as std::less<std::string>, but not std::less: no inline-prefix fast path
+struct FullCompare {
+    bool operator()(const std::string& a, const std::string& b) const { return a < b; }
+    int compare(const std::string& a, const std::string& b) const { return a.compare(b); }
+};
+
+// Hash-like ids (leading bytes differ), long enough to live on the heap
+std::string id_key(size_t i) {
+    static const char hex[] = "0123456789abcdef";
+    uint64_t h = (i + 1) * 0x9E3779B97F4A7C15ull;
+    h ^= h >> 31;
+    std::string s(16, '0');
+    for (int d = 15; d >= 0; d--, h >>= 4) s[d] = hex[h & 15];
+    return s + "/object";
+}
+
+template <typename Tree, typename Probe>
+void time_string_lookups(const char* label, const Tree& tree, const std::vector<std::string>& probes, Probe probe) {
+    constexpr int RUNS = 3;                 // Best of; the first pass over a tree runs cold
+    size_t before = thread_allocations;
+    size_t compares_before = key_comparisons;
+    double mops = 0.0;
+    size_t hits = 0;
+    for (int run = 0; run < RUNS; run++) {
+        mops = std::max(mops, timed_mops(probes.size(), [&] {
+            for (const std::string& p : probes) hits += probe(tree, p);
+        }));
+    }
+    result_sink = hits;                     // Keeps lock-free probes from being optimised out
+    double allocs = static_cast<double>(thread_allocations - before) / (RUNS * probes.size());
+    double compares = static_cast<double>(key_comparisons - compares_before) / (RUNS * probes.size());
+    std::cout << label << std::setw(10) << mops << " Mop/s  " << std::setw(6) << allocs << " allocs/lookup";
+    if (compares > 0.0) std::cout << "  " << std::setw(6) << compares << " compares/lookup";
+    std::cout << "\n";
+}
+
+void run_string_keys(const BenchConfig& config) {
+    std::vector<std::string> probes;
+    for (size_t i = 0; i < config.keys; i++) probes.push_back(string_key(i));
+    std::shuffle(probes.begin(), probes.end(), std::mt19937(3));
+
+    rbt::RBTree<std::string, int> plain;
+    rbt::RBTree<std::string, int, std::less<>> transparent;
+    rbt::RBTree<std::string, int, CountingLess> two_calls;
+    rbt::RBTree<std::string, int, CountingThreeWay> three_way;
+    for (size_t i = 0; i < probes.size(); i += 2) {             // Half the probes hit
+        plain.insert(probes[i], static_cast<int>(i));
+        transparent.insert(probes[i], static_cast<int>(i));
+        two_calls.insert(probes[i], static_cast<int>(i));
+        three_way.insert(probes[i], static_cast<int>(i));
+    }
+
+    std::cout << "\n==== String Keys (1 thread) ====\n" << std::fixed << std::setprecision(2);
+    time_string_lookups("lookup(std::string(view))   ", plain, probes,
+                        [](const auto& tree, std::string_view v) { return tree.lookup(std::string(v)).has_value(); });
+    time_string_lookups("lookup(view), std::less<>   ", transparent, probes,
+                        [](const auto& tree, std::string_view v) { return tree.lookup(v).has_value(); });
+    time_string_lookups("lookup, comp() twice/level  ", two_calls, probes,
+                        [](const auto& tree, std::string_view v) { return tree.lookup(std::string(v)).has_value(); });
+    time_string_lookups("lookup, compare() once/level", three_way, probes,
+                        [](const auto& tree, std::string_view v) { return tree.lookup(std::string(v)).has_value(); });
+
+    std::vector<std::string> ids;
+    for (size_t i = 0; i < config.keys; i++) ids.push_back(id_key(i));
+    rbt::RBTree<std::string, int, FullCompare> full;
+    rbt::RBTree<std::string, int> prefixed;
+    for (size_t i = 0; i < ids.size(); i += 2) {
+        full.insert(ids[i], static_cast<int>(i));
+        prefixed.insert(ids[i], static_cast<int>(i));
+    }
+    std::shuffle(ids.begin(), ids.end(), std::mt19937(5));     // Probe order unrelated to node layout
+    time_string_lookups("ids, lookup_hybrid, full key", full, ids,
+                        [](const auto& tree, const std::string& k) { return tree.lookup_hybrid(k).has_value(); });
+    time_string_lookups("ids, lookup_hybrid, prefix  ", prefixed, ids,
+                        [](const auto& tree, const std::string& k) { return tree.lookup_hybrid(k).has_value(); });
+}
+
+template <typename Tree>
+void print_memory_row(const char* label, const Tree& tree) {
+    rbt::MemoryStats m = tree.memory_stats();
+    std::cout << std::left << std::setw(22) << label << std::right
+              << std::setw(8) << m.bytes_per_node() << std::setw(9) << m.payload_bytes
+              << std::setw(7) << m.lock_bytes << std::setw(7) << m.link_bytes
+              << std::setw(7) << m.other_bytes << std::setw(5) << m.padding_bytes
+              << std::setw(7) << m.allocator_slack << std::setw(10) << std::fixed << std::setprecision(1)
+              << m.total_bytes() / 1048576.0 << "\n";
+}
+
+void run_memory_stats(const BenchConfig& config) {
+    std::vector<std::pair<int, int>> ints(config.keys);
+    for (size_t i = 0; i < config.keys; i++) ints[i] = {static_cast<int>(i), static_cast<int>(i)};
+    rbt::RBTree<int, int> int_tree;
+    int_tree.bulk_load(ints);
+
+    std::vector<std::pair<std::string, int>> strings(config.keys);
+    for (size_t i = 0; i < config.keys; i++) strings[i] = {string_key(i), static_cast<int>(i)};
+    rbt::RBTree<std::string, int> string_tree;
+    string_tree.bulk_load(strings);
+
+    std::cout << "\n==== Memory per Node (" << config.keys << " nodes) ====\n"
+              << std::left << std::setw(22) << "tree" << std::right
+              << std::setw(8) << "bytes" << std::setw(9) << "payload" << std::setw(7) << "locks"
+              << std::setw(7) << "links" << std::setw(7) << "other" << std::setw(5) << "pad"
+              << std::setw(7) << "alloc" << std::setw(10) << "total MiB" << "\n";
+    print_memory_row("RBTree<int, int>", int_tree);
+    print_memory_row("RBTree<string, int>", string_tree);
+}
+
+// Whole-tree integrity checks: recursive validate() against
+// validate_parallel() on 1 and config.threads workers
+void run_validation(const BenchConfig& config) {
+    std::vector<int> keys(config.keys);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+    rbt::RBTree<int, int> tree;
+    for (int k : keys) tree.insert(k, k);
+
+    auto time_ms = [](auto&& check) {
+        auto t0 = std::chrono::steady_clock::now();
+        bool ok = check();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        return std::make_pair(ok, ms);
+    };
+    auto row = [](const std::string& label, std::pair<bool, double> r) {
+        std::cout << std::left << std::setw(35) << label << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(10) << r.second << " ms" << (r.first ? "" : "  INVALID") << "\n";
+    };
+    std::cout << "\n==== Validation (" << config.keys << " nodes) ====\n";
+    row("validate()", time_ms([&] { return tree.validate(); }));
+    row("validate_parallel(1)", time_ms([&] { return tree.validate_parallel(1); }));
+    row("validate_parallel(" + std::to_string(config.threads) + ")",
+        time_ms([&] { return tree.validate_parallel(static_cast<unsigned>(config.threads)); }));
+}
+
+// YCSB core workloads (ycsb_workload.cpp) over `keys` ordered records,
+// config.threads clients, config.duration per workload and engine
+void run_ycsb(const BenchConfig& config) {
+    std::cout << "\n==== YCSB (" << config.keys << " records, " << config.threads << " clients) ====\n"
+              << std::left << std::setw(30) << "workload" << std::right
+              << std::setw(14) << "RBTree Mop/s" << std::setw(14) << "B+tree Mop/s" << "\n";
+    std::vector<std::pair<int, int>> sorted(config.keys);
+    for (size_t i = 0; i < config.keys; i++) sorted[i] = {static_cast<int>(i), static_cast<int>(i)};
+
+    for (char letter : std::string("ABCDEF")) {
+        rbt::YcsbWorkload w = rbt::YcsbWorkload::preset(letter);
+        std::string label = std::string("YCSB-") + letter + " (" + w.description + ")";
+        std::cout << std::left << std::setw(30) << label << std::right << std::fixed << std::setprecision(2);
+
+        rbt::RBTree<int, int> rb;
+        rb.bulk_load(sorted);
+        double rb_mops = rbt::run_ycsb(rb, w, config.keys, config.threads, config.duration).ops_per_sec() / 1e6;
+        records.emit(config, "ycsb", label, "rbtree_mops", rb_mops);
+        std::cout << std::setw(14) << rb_mops;
+
+        if (w.proportion[static_cast<size_t>(rbt::YcsbOp::SCAN)] > 0.0) {
+            std::cout << std::setw(14) << "n/a" << "\n";      // No ordered scan on BPlusTree
+            continue;
+        }
+        rbt::BPlusTree<int, int> bp;
+        for (const auto& kv : sorted) bp.insert(kv.first, kv.second);
+        double bp_mops = rbt::run_ycsb(bp, w, config.keys, config.threads, config.duration).ops_per_sec() / 1e6;
+        records.emit(config, "ycsb", label, "bplus_mops", bp_mops);
+        std::cout << std::setw(14) << bp_mops << "\n";
+    }
+}
+
+template <typename Tree>
+void print_shape_row(const std::string& label, const Tree& tree) {
+    auto t0 = std::chrono::steady_clock::now();
+    rbt::ShapeStats s = tree.shape_stats();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << std::left << std::setw(26) << label << std::right << std::setw(10) << s.nodes
+              << std::setw(8) << s.height << std::setw(8) << s.black_height << std::fixed << std::setprecision(2)
+              << std::setw(11) << s.mean_depth() << std::setw(9) << std::log2(double(s.nodes) + 1.0)
+              << std::setw(11) << s.imbalance() << std::setw(10) << ms << "\n";
+}
+
+// Lookup path length as the tree grows (random order), against the
+// sequential-insert and bulk_load() shapes of the same keys
+void run_tree_shape(const BenchConfig& config) {
+    std::cout << "\n==== Tree Shape ====\n"
+              << std::left << std::setw(26) << "tree" << std::right << std::setw(10) << "nodes"
+              << std::setw(8) << "height" << std::setw(8) << "black" << std::setw(11) << "mean depth"
+              << std::setw(9) << "log2 n" << std::setw(11) << "imbalance" << std::setw(10) << "stats ms" << "\n";
+
+    std::vector<int> keys(config.keys);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+    rbt::RBTree<int, int> random_tree;
+    size_t next_report = std::min<size_t>(1000, config.keys);
+    for (size_t i = 0; i < keys.size(); i++) {
+        random_tree.insert(keys[i], keys[i]);
+        if (i + 1 == next_report) {
+            print_shape_row("random inserts", random_tree);
+            next_report = std::min(next_report * 10, config.keys);
+        }
+    }
+
+    rbt::RBTree<int, int> sequential_tree;
+    for (size_t i = 0; i < config.keys; i++) sequential_tree.insert(static_cast<int>(i), static_cast<int>(i));
+    print_shape_row("sequential inserts", sequential_tree);
+
+    std::vector<std::pair<int, int>> sorted(config.keys);
+    for (size_t i = 0; i < config.keys; i++) sorted[i] = {static_cast<int>(i), static_cast<int>(i)};
+    rbt::RBTree<int, int> loaded_tree;
+    loaded_tree.bulk_load(sorted);
+    print_shape_row("bulk_load()", loaded_tree);
+}
+
+int main(int argc, char** argv) {
+    BenchConfig config;
+    std::vector<std::string> positional;
+    std::string output;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--format=", 0) == 0) records.format = arg.substr(9);
+        else if (arg.rfind("--output=", 0) == 0) output = arg.substr(9);
+        else positional.push_back(arg);
+    }
+    if (!records.format.empty() && records.format != "json" && records.format != "csv") {
+        std::cerr << "--format must be json or csv\n";
+        return 2;
+    }
+    if (positional.size() > 0) config.keys = std::strtoull(positional[0].c_str(), nullptr, 10);
+    if (positional.size() > 1) config.threads = std::max<size_t>(1, std::strtoull(positional[1].c_str(), nullptr, 10));
+    if (positional.size() > 2) {
+        config.duration = std::chrono::milliseconds(static_cast<long>(std::atof(positional[2].c_str()) * 1000));
+    }
+
+    std::ofstream file;
+    std::streambuf* table_buf = std::cout.rdbuf();
+    std::ostream stdout_records(table_buf);
+    if (!records.format.empty()) {
+        bool header = records.format == "csv";
+        if (!output.empty()) {
+            header = header && std::ifstream(output).peek() == std::ifstream::traits_type::eof();
+            file.open(output, std::ios::app);
+            if (!file) {
+                std::cerr << "cannot open " << output << "\n";
+                return 2;
+            }
+            records.out = &file;
+        } else {
+            records.out = &stdout_records;
+            std::cout.rdbuf(std::cerr.rdbuf());
+        }
+        if (header) *records.out << "table,row,metric,value,keys,threads,duration_ms\n";
+    }
+
+    std::cout << "==== Tree Engine Benchmark ====\n"
+              << "keys=" << config.keys << " threads=" << config.threads
+              << " duration/phase=" << config.duration.count() << "ms\n\n"
+              << std::left << std::setw(30) << "engine" << std::right
+              << std::setw(14) << "build Mop/s" << std::setw(14) << "lookup Mop/s"
+              << std::setw(14) << "mixed Mop/s" << "\n"
+              << std::string(72, '-') << "\n";
+
+    // RBTree, Strategy 2 reads + optimistic writers (writers_mutex)
+    {
+        rbt::RBTree<int, int> tree;
+        Engine e{"RBTree lookup/insert/erase",
+                 [&](int k, int v) { tree.insert(k, v); },
+                 [&](int k) { return tree.erase(k); },
+                 [&](int k) { return tree.lookup(k).has_value(); },
+                 nullptr};
+        print_row(config, e.name, run_engine(config, e));
+    }
+
+    // RBTree, Strategy 3: global reader-writer lock on both sides
+    {
+        rbt::RBTree<int, int> tree;
+        Engine e{"RBTree *_hybrid",
+                 [&](int k, int v) { tree.insert_hybrid(k, v); },
+                 [&](int k) { return tree.erase_hybrid(k); },
+                 [&](int k) { return tree.lookup_hybrid(k).has_value(); },
+                 nullptr};
+        print_row(config, e.name, run_engine(config, e));
+    }
+
+    // B+tree engine: optimistic lock coupling, SIMD in-node search
+    {
+        rbt::BPlusTree<int, int> tree;
+        Engine e{"BPlusTree (OLC)",
+                 [&](int k, int v) { tree.insert(k, v); },
+                 [&](int k) { return tree.erase(k); },
+                 [&](int k) { return tree.lookup(k).has_value(); },
+                 nullptr};
+        print_row(config, e.name, run_engine(config, e));
+    }
+
+    // Read-only serving: RBTree::freeze() into an Eytzinger layout
+    {
+        rbt::RBTree<int, int> tree;
+        rbt::EytzingerTree<int, int> frozen;
+        Engine e{"RBTree::freeze() (read-only)",
+                 [&](int k, int v) { tree.insert(k, v); },
+                 [&](int k) { return tree.erase(k); },
+                 [&](int k) { return frozen.lookup(k).has_value(); },
+                 [&] { frozen = tree.freeze(); },
+                 true};
+        print_row(config, e.name, run_engine(config, e));
+    }
+
+    run_finger_search(config);
+    run_navigation(config);
+    run_string_keys(config);
+    run_erase_churn(config);
+    run_teardown(config);
+    run_memory_stats(config);
+    run_tree_shape(config);
+    run_validation(config);
+    run_ycsb(config);
+    std::cout.rdbuf(table_buf);
+    return 0;
+}
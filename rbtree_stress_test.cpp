@@ -2,24 +2,120 @@
 // Comprehensive stress test for thread-safe lock-based red-black tree
 // -------------------------------------------------------------------
 // Build: g++ -std=c++17 -pthread -O2 rbtree_stress_test.cpp -o rbtree_stress_test
+//        (add -DRBT_ENABLE_STATS to print rotation / fixup / lock-contention counters,
+//         -DRBT_PROFILE_LOCKS to print per-call-site lock wait / hold histograms)
+// Usage: ./rbtree_stress_test                  built-in test suite
+//        ./rbtree_stress_test --help           scenario options (any TestConfig field,
+//                                              engine, config file, JSON / CSV output)
 
 #include <algorithm>
 #include <atomic>
 #include <cassert>
+#include <cmath>
 #include <chrono>
+#include <fstream>
+#include <functional>
 #include <iomanip>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <numeric>
+#include <optional>
 #include <random>
+#include <shared_mutex>
+#include <sstream>
+#include <stdexcept>
 #include <string>
 #include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
-// Include the RB-tree implementation
+// Include the RB-tree implementation, the alternative B+tree engine and the
+// YCSB workload generator
 #include "lock_based_rb_tree.cpp"
+#include "bplus_tree.cpp"
+#include "ycsb_workload.cpp"
+
+// Engines that expose writer_mutex() can be validated while the test runs;
+// optimistic engines (BPlusTree) are validated only once all threads joined.
+template <typename Tree, typename = void>
+struct supports_online_validation : std::false_type {};
+template <typename Tree>
+struct supports_online_validation<Tree, std::void_t<decltype(std::declval<const Tree&>().writer_mutex())>>
+    : std::true_type {};
+
+// Engines with optional lookup() front structures (RBTree::enable_hot_cache,
+// RBTree::enable_negative_filter)
+template <typename Tree, typename = void>
+struct supports_hot_cache : std::false_type {};
+template <typename Tree>
+struct supports_hot_cache<Tree, std::void_t<decltype(std::declval<Tree&>().enable_hot_cache(size_t{}))>>
+    : std::true_type {};
+template <typename Tree, typename = void>
+struct supports_negative_filter : std::false_type {};
+template <typename Tree>
+struct supports_negative_filter<Tree, std::void_t<decltype(std::declval<Tree&>().enable_negative_filter())>>
+    : std::true_type {};
+
+template <typename Tree, typename = void>
+struct supports_memory_stats : std::false_type {};
+template <typename Tree>
+struct supports_memory_stats<Tree, std::void_t<decltype(std::declval<const Tree&>().memory_stats())>>
+    : std::true_type {};
+
+template <typename Tree, typename = void>
+struct supports_incremental_validation : std::false_type {};
+template <typename Tree>
+struct supports_incremental_validation<Tree, std::void_t<typename Tree::ValidationCursor>>
+    : std::true_type {};
+
+template <typename Tree, typename = void>
+struct supports_parallel_validation : std::false_type {};
+template <typename Tree>
+struct supports_parallel_validation<Tree, std::void_t<decltype(std::declval<const Tree&>().validate_parallel(1u))>>
+    : std::true_type {};
+
+template <typename Tree, typename = void>
+struct supports_shape_stats : std::false_type {};
+template <typename Tree>
+struct supports_shape_stats<Tree, std::void_t<decltype(std::declval<const Tree&>().shape_stats())>>
+    : std::true_type {};
+
+template <typename Tree, typename = void>
+struct supports_op_stats : std::false_type {};
+template <typename Tree>
+struct supports_op_stats<Tree, std::void_t<decltype(std::declval<const Tree&>().op_stats())>>
+    : std::true_type {};
+
+template <typename Tree, typename = void>
+struct supports_lock_profile : std::false_type {};
+template <typename Tree>
+struct supports_lock_profile<Tree, std::void_t<decltype(std::declval<const Tree&>().lock_profile())>>
+    : std::true_type {};
+
+// validate_locked() takes writer_mutex() itself, through the profiled guard
+template <typename Tree, typename = void>
+struct supports_locked_validation : std::false_type {};
+template <typename Tree>
+struct supports_locked_validation<Tree, std::void_t<decltype(std::declval<const Tree&>().validate_locked())>>
+    : std::true_type {};
+
+template <typename Tree> const char* engine_name() { return "rbt::RBTree"; }
+template <> const char* engine_name<rbt::BPlusTree<int, int>>() { return "rbt::BPlusTree"; }
+
+// Harness-only engine: every operation is a no-op, so a stress run against it
+// measures what the harness itself (key generation, counters, latency
+// sampling, write logs) costs per operation. Never compared with the
+// reference.
+struct NullTree {
+    void insert(int, int) {}
+    bool erase(int) { return false; }
+    std::optional<int> lookup(int) const { return std::nullopt; }
+    bool validate() const { return true; }
+};
+template <> const char* engine_name<NullTree>() { return "null (harness only)"; }
 
 // Configuration parameters
 struct TestConfig {
@@ -33,22 +129,77 @@ struct TestConfig {
     size_t validation_interval = 10000; // How often to validate (operations)
     std::chrono::seconds test_duration{30}; // Maximum test duration
     bool verify_results = true;        // Verify final state against reference
+    double zipf_theta = 0.0;           // Key skew for reader/writer threads (0 = uniform)
+    std::optional<rbt::KeyDistribution> key_distribution; // Overrides the above / the YCSB preset's
+    char ycsb_workload = 'A';          // run_ycsb_test() preset, 'A'-'F'
+    size_t hot_cache_sets = 0;         // RBTree::enable_hot_cache() sets (0 = disabled)
+    bool negative_filter = false;      // RBTree::enable_negative_filter() after initialization
+    size_t validation_slice = 0;       // > 0: only the validator thread validates, through
+                                       // validate_slice() over this many nodes at a time
+};
+
+// Value at percentile p (0..100) of an ascending-sorted sample
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t idx = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+// Reader / writer threads time one operation in this many
+constexpr size_t LATENCY_SAMPLE_EVERY = 16;
+
+double elapsed_us(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - since).count();
+}
+
+// Operation counters of one reader / writer thread. Each sits on its own
+// cache line and is written only by its thread, so counting costs a plain
+// increment instead of a contended atomic; TestStats::collect() sums them
+// once the threads joined.
+struct alignas(64) ThreadCounters {
+    size_t lookups = 0;
+    size_t lookup_hits = 0;
+    size_t inserts = 0;
+    size_t insert_hits = 0;
+    size_t deletes = 0;
+    size_t delete_hits = 0;
 };
 
 // Statistics tracking
 struct TestStats {
-    std::atomic<size_t> total_lookups{0};
-    std::atomic<size_t> successful_lookups{0};
-    std::atomic<size_t> total_inserts{0};
-    std::atomic<size_t> successful_inserts{0};
-    std::atomic<size_t> total_deletes{0};
-    std::atomic<size_t> successful_deletes{0};
+    std::vector<ThreadCounters> reader_counters;   // Indexed by thread id
+    std::vector<ThreadCounters> writer_counters;
+    size_t total_lookups = 0;                      // Totals, set by collect()
+    size_t successful_lookups = 0;
+    size_t total_inserts = 0;
+    size_t successful_inserts = 0;
+    size_t total_deletes = 0;
+    size_t successful_deletes = 0;
     std::atomic<size_t> validation_count{0};
     std::vector<double> reader_throughput;
     std::vector<double> writer_throughput;
+    std::vector<double> read_latency_us;    // Sampled lookups, sorted once the threads joined
+    std::vector<double> write_latency_us;   // Sampled inserts and erases, likewise
     std::chrono::milliseconds total_runtime{0};
     std::mutex agg_mtx;
     
+    TestStats(size_t readers, size_t writers) : reader_counters(readers), writer_counters(writers) {}
+    
+    void collect() {
+        total_lookups = successful_lookups = total_inserts = successful_inserts = 0;
+        total_deletes = successful_deletes = 0;
+        for (const auto* counters : {&reader_counters, &writer_counters}) {
+            for (const ThreadCounters& c : *counters) {
+                total_lookups += c.lookups;
+                successful_lookups += c.lookup_hits;
+                total_inserts += c.inserts;
+                successful_inserts += c.insert_hits;
+                total_deletes += c.deletes;
+                successful_deletes += c.delete_hits;
+            }
+        }
+    }
+    
     void print() const {
         std::cout << "\n==== Test Statistics ====\n";
         std::cout << "Total runtime: " << total_runtime.count() << " ms\n";
@@ -78,6 +229,15 @@ struct TestStats {
             std::cout << "Writer throughput (ops/sec): avg=" << std::fixed << std::setprecision(2) << avg_writer 
                       << ", min=" << min_writer << ", max=" << max_writer << "\n";
         }
+        
+        auto print_latency = [](const char* what, const std::vector<double>& sorted) {
+            if (sorted.empty()) return;
+            std::cout << what << " latency (us, 1 in " << LATENCY_SAMPLE_EVERY << " sampled): p50="
+                      << std::fixed << std::setprecision(2) << percentile(sorted, 50.0)
+                      << ", p99=" << percentile(sorted, 99.0) << ", max=" << sorted.back() << "\n";
+        };
+        print_latency("Lookup", read_latency_us);
+        print_latency("Write", write_latency_us);
     }
 };
 
@@ -92,7 +252,11 @@ private:
 
 public:
     // Try to start a validation if one is not already in progress
-    bool try_validate(const rbt::RBTree<int, int>& tree, const std::string& context) {
+    template <typename Tree>
+    bool try_validate(const Tree& tree, const std::string& context) {
+        if constexpr (!supports_online_validation<Tree>::value) {
+            return false;   // No way to quiesce writers; checked after the run
+        }
         if (validation_in_progress.load(std::memory_order_relaxed)) {
             // Another thread is already validating
             return false;
@@ -110,9 +274,13 @@ public:
 
         /* 🔒  Lock the tree’s writers-mutex so no writer mutates the structure
         while we run the (read-only) validate() traversal. */
-        std::lock_guard<std::mutex> guard(tree.writer_mutex());
-
-        bool valid = tree.validate();
+        bool valid = true;
+        if constexpr (supports_locked_validation<Tree>::value) {
+            valid = tree.validate_locked();
+        } else if constexpr (supports_online_validation<Tree>::value) {
+            std::lock_guard<std::mutex> guard(tree.writer_mutex());
+            valid = tree.validate();
+        }
         validations_performed++;
         
         if (!valid) {
@@ -124,6 +292,22 @@ public:
         return valid;
     }
     
+    // Check the next slice of the tree; a validation is counted once a pass
+    // over the whole key range completes
+    template <typename Tree>
+    bool validate_slice(const Tree& tree, typename Tree::ValidationCursor& cursor, size_t nodes,
+                        const std::string& context) {
+        uint64_t passes = cursor.passes;
+        bool valid = tree.validate_slice(cursor, nodes);
+        if (!valid) {
+            std::cerr << "VALIDATION FAILED during " << context << " (pass " << passes << ")!\n";
+            validation_failed = true;
+        } else if (cursor.passes != passes) {
+            validations_performed++;
+        }
+        return valid;
+    }
+    
     size_t get_validations_performed() const {
         return validations_performed.load();
     }
@@ -133,6 +317,21 @@ public:
     }
 };
 
+// One ZipfianGenerator per (key range, theta), shared by every thread that
+// asks while it is alive: setup is O(key_range), the generator immutable
+std::shared_ptr<const rbt::ZipfianGenerator> shared_zipfian(size_t range, double theta) {
+    static std::mutex mutex;
+    static std::map<std::pair<size_t, double>, std::weak_ptr<const rbt::ZipfianGenerator>> live;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& slot = live[{range, theta}];
+    auto zipf = slot.lock();
+    if (!zipf) {
+        zipf = std::make_shared<const rbt::ZipfianGenerator>(range, theta);
+        slot = zipf;
+    }
+    return zipf;
+}
+
 // Helper to generate random keys and values
 class RandomGenerator {
 private:
@@ -141,12 +340,29 @@ private:
     std::uniform_int_distribution<int> val_dist;
     std::uniform_real_distribution<double> op_dist{0.0, 1.0};
     
+    // Skewed keys come from ycsb_workload.cpp; zipf_theta > 0 alone means ZIPFIAN
+    size_t range;
+    rbt::KeyDistribution dist;
+    std::shared_ptr<const rbt::ZipfianGenerator> zipf;
+    std::unique_ptr<rbt::KeyChooser> keys;
+    
 public:
-    RandomGenerator(size_t key_range, size_t seed) 
-        : gen(seed), key_dist(0, key_range - 1), val_dist(0, std::numeric_limits<int>::max()) {}
+    RandomGenerator(size_t key_range, size_t seed, double zipf_theta = 0.0,
+                    std::optional<rbt::KeyDistribution> distribution = std::nullopt)
+        : gen(seed), key_dist(0, key_range - 1), val_dist(0, std::numeric_limits<int>::max()),
+          range(key_range),
+          dist(distribution.value_or(zipf_theta > 0.0 ? rbt::KeyDistribution::ZIPFIAN : rbt::KeyDistribution::UNIFORM)) {
+        assert(zipf_theta < 1.0 && "zipf_theta must be in [0, 1)");
+        if (dist == rbt::KeyDistribution::ZIPFIAN || dist == rbt::KeyDistribution::LATEST) {
+            zipf = shared_zipfian(range, zipf_theta > 0.0 ? zipf_theta : 0.99);
+        }
+        if (dist != rbt::KeyDistribution::UNIFORM) {
+            keys = std::make_unique<rbt::KeyChooser>(dist, zipf.get(), seed);
+        }
+    }
     
     int random_key() {
-        return key_dist(gen);
+        return keys ? static_cast<int>(keys->next(range)) : key_dist(gen);
     }
     
     int random_value() {
@@ -158,7 +374,30 @@ public:
     }
 };
 
-// Reference implementation to verify results
+// One writer's last write to each key it touched. start / end come from
+// the shared WriteClock, taken just before the tree operation and just
+// after it returns; a thread's earlier writes to a key end before its later
+// ones start, so only the last can still have landed last in the tree.
+struct alignas(64) WriteLog {
+    struct Write {
+        int val;
+        bool erase;
+        uint64_t start;
+        uint64_t end;
+    };
+    std::unordered_map<int, Write> last;
+    
+    void record(int key, int val, bool erase, uint64_t start, uint64_t end) {
+        last[key] = Write{val, erase, start, end};
+    }
+};
+
+using WriteClock = std::atomic<uint64_t>;
+
+// Reference implementation to verify results. It holds the keys loaded
+// before the threads start; writers leave it alone and log into their own
+// WriteLog instead, so no harness lock sits around a tree operation and
+// writers racing on one key really race in the tree.
 class ReferenceMap {
 private:
     std::unordered_map<int, int> map;
@@ -187,23 +426,64 @@ public:
         return map.size();
     }
     
-    // Compare with RB tree (not thread-safe, call when testing is complete)
-    bool compare_with_tree(const rbt::RBTree<int, int>& tree) {
+    // Compare with RB tree after replaying the writers' logs last-writer-wins
+    // (not thread-safe, call when testing is complete). A key's final write
+    // is the one that started last; any write that ended after that start
+    // overlapped it, may have landed after it, and is accepted as well.
+    template <typename Tree>
+    bool compare_with_tree(const Tree& tree, const std::vector<WriteLog>& logs) const {
         std::shared_lock lock(mutex);
+        
+        std::unordered_map<int, uint64_t> last_start;
+        for (const WriteLog& log : logs) {
+            for (const auto& [key, w] : log.last) {
+                uint64_t& latest = last_start[key];
+                latest = std::max(latest, w.start);
+            }
+        }
+        
+        auto describe = [](const std::optional<int>& v) {
+            return v ? std::to_string(*v) : std::string("not found");
+        };
+        std::unordered_map<int, size_t> candidates;   // Writes that may have landed last
+        std::unordered_map<int, bool> matched;
+        for (const WriteLog& log : logs) {
+            for (const auto& [key, w] : log.last) {
+                if (w.end < last_start[key]) continue;   // Finished before the final write began
+                candidates[key]++;
+                auto tree_val = tree.lookup(key);
+                matched[key] |= w.erase ? !tree_val : (tree_val && *tree_val == w.val);
+            }
+        }
+        size_t racing = 0;
+        for (const auto& [key, ok] : matched) {
+            if (candidates[key] > 1) racing++;
+            if (!ok) {
+                std::cerr << "Mismatch for key " << key << ": none of its " << candidates[key]
+                          << " final write(s) matches, tree=" << describe(tree.lookup(key)) << "\n";
+                return false;
+            }
+        }
+        
+        // Keys no writer touched keep their initial value
         for (const auto& [key, val] : map) {
+            if (last_start.count(key)) continue;
             auto tree_val = tree.lookup(key);
             if (!tree_val || *tree_val != val) {
                 std::cerr << "Mismatch for key " << key << ": reference=" << val 
-                          << ", tree=" << (tree_val ? std::to_string(*tree_val) : "not found") << "\n";
+                          << ", tree=" << describe(tree_val) << "\n";
                 return false;
             }
         }
+        std::cout << "Reference replay: " << last_start.size() << " written keys, "
+                  << racing << " with racing final writes\n";
         return true;
     }
 };
 
 // Running the tests
-void initialize_tree(rbt::RBTree<int, int>& tree, ReferenceMap& reference, const TestConfig& config) {
+template <typename Tree>
+void initialize_tree(Tree& tree, ReferenceMap& reference, const TestConfig& config) {
     std::cout << "Initializing tree with " << config.initial_elements << " elements...\n";
     
     // Use deterministic seed for reproducibility
@@ -225,34 +505,38 @@ void initialize_tree(rbt::RBTree<int, int>& tree, ReferenceMap& reference, const
 }
 
 // Reader thread function
+template <typename Tree>
 void reader_thread_func(
-    rbt::RBTree<int, int>& tree,
+    Tree& tree,
     const TestConfig& config,
     TestStats& stats,
     TreeValidator& validator,
     std::atomic<bool>& stop_flag,
     size_t thread_id
 ) {
-    RandomGenerator rng(config.key_range, thread_id + 1000);
-    size_t ops = 0;
-    size_t successful = 0;
+    RandomGenerator rng(config.key_range, thread_id + 1000, config.zipf_theta, config.key_distribution);
+    ThreadCounters& counters = stats.reader_counters[thread_id];
+    size_t& ops = counters.lookups;
+    size_t& successful = counters.lookup_hits;
+    std::vector<double> latencies;
     
     auto start_time = std::chrono::high_resolution_clock::now();
     
-    while (!stop_flag.load() && ops < config.operations_per_thread) {
+    while (!stop_flag.load(std::memory_order_relaxed) && ops < config.operations_per_thread) {
         int key = rng.random_key();
+        bool timed = ops % LATENCY_SAMPLE_EVERY == 0;
+        auto op_start = timed ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
         auto value = tree.lookup(key);
-        stats.total_lookups++;
+        if (timed) latencies.push_back(elapsed_us(op_start));
         
         if (value) {
             successful++;
-            stats.successful_lookups++;
         }
         
         ops++;
         
         // Occasionally try to validate the tree
-        if (config.validate_periodically && ops % config.validation_interval == 0) {
+        if (config.validate_periodically && config.validation_slice == 0 && ops % config.validation_interval == 0) {
             validator.try_validate(tree, "reader thread");
         }
     }
@@ -271,6 +555,7 @@ void reader_thread_func(
     {
         std::lock_guard<std::mutex> lock(stats.agg_mtx);
         stats.reader_throughput.push_back(throughput);
+        stats.read_latency_us.insert(stats.read_latency_us.end(), latencies.begin(), latencies.end());
     }
     
     std::cout << "Reader " << thread_id << " completed " << ops << " lookups (" 
@@ -279,57 +564,62 @@ void reader_thread_func(
 }
 
 // Writer thread function
+template <typename Tree>
 void writer_thread_func(
-    rbt::RBTree<int, int>& tree,
-    ReferenceMap& reference,
+    Tree& tree,
+    WriteLog& log,
+    WriteClock& clock,
     const TestConfig& config,
     TestStats& stats,
     TreeValidator& validator,
     std::atomic<bool>& stop_flag,
     size_t thread_id
 ) {
-    RandomGenerator rng(config.key_range, thread_id + 2000);
-    size_t inserts = 0, successful_inserts = 0;
-    size_t deletes = 0, successful_deletes = 0;
+    RandomGenerator rng(config.key_range, thread_id + 2000, config.zipf_theta, config.key_distribution);
+    ThreadCounters& counters = stats.writer_counters[thread_id];
+    size_t& inserts = counters.inserts;
+    size_t& deletes = counters.deletes;
+    std::vector<double> latencies;
     
     auto start_time = std::chrono::high_resolution_clock::now();
     
-    while (!stop_flag.load() && (inserts + deletes) < config.operations_per_thread) {
+    while (!stop_flag.load(std::memory_order_relaxed) && (inserts + deletes) < config.operations_per_thread) {
         // Decide whether to insert or delete
         bool do_insert = rng.random_probability() < config.insert_ratio;
+        bool timed = (inserts + deletes) % LATENCY_SAMPLE_EVERY == 0;
         
+        // The clock is read around the tree operation only; no harness lock
+        // is held across it. Only the tree operation is timed
+        int key = rng.random_key();
         if (do_insert) {
-            int key = rng.random_key();
             int val = rng.random_value();
             
-            // Update both tree and reference
+            uint64_t start = clock.fetch_add(1);
+            auto op_start = timed ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
             tree.insert(key, val);
-            reference.insert(key, val);
+            uint64_t end = clock.fetch_add(1);
+            if (timed) latencies.push_back(elapsed_us(op_start));
+            log.record(key, val, false, start, end);
             
-            stats.total_inserts++;
             inserts++;
-            successful_inserts++;
-            stats.successful_inserts++;
+            counters.insert_hits++;
         } else {
-            int key = rng.random_key();
-            
-            // Try to delete from both
+            uint64_t start = clock.fetch_add(1);
+            auto op_start = timed ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
             bool success = tree.erase(key);
-            reference.erase(key);
-            stats.total_deletes++;
+            uint64_t end = clock.fetch_add(1);
+            if (timed) latencies.push_back(elapsed_us(op_start));
+            log.record(key, 0, true, start, end);
+            
             deletes++;
             if (success) {
-                // reference.erase(key);
-                successful_deletes++;
-                stats.successful_deletes++;
+                counters.delete_hits++;
             }
-            
-            stats.total_deletes++;
-            deletes++;
         }
         
         // Occasionally try to validate the tree
-        if (config.validate_periodically && (inserts + deletes) % config.validation_interval == 0) {
+        if (config.validate_periodically && config.validation_slice == 0 &&
+            (inserts + deletes) % config.validation_interval == 0) {
             validator.try_validate(tree, "writer thread");
         }
     }
@@ -348,6 +638,7 @@ void writer_thread_func(
     {
         std::lock_guard<std::mutex> lock(stats.agg_mtx);
         stats.writer_throughput.push_back(throughput);
+        stats.write_latency_us.insert(stats.write_latency_us.end(), latencies.begin(), latencies.end());
     }
     
     std::cout << "Writer " << thread_id << " completed " << inserts << " inserts + " 
@@ -356,8 +647,9 @@ void writer_thread_func(
 }
 
 // Periodic validator thread function
+template <typename Tree>
 void validator_thread_func(
-    rbt::RBTree<int, int>& tree,
+    Tree& tree,
     TreeValidator& validator,
     std::atomic<bool>& stop_flag,
     const TestConfig& config,
@@ -365,6 +657,21 @@ void validator_thread_func(
 ) {
     const auto validation_sleep = std::chrono::milliseconds(500);
     
+    if constexpr (supports_incremental_validation<Tree>::value) {
+        if (config.validation_slice > 0) {
+            typename Tree::ValidationCursor cursor;
+            while (!stop_flag.load()) {
+                uint64_t passes = cursor.passes;
+                if (validator.validate_slice(tree, cursor, config.validation_slice, "validator thread")
+                    && cursor.passes != passes) {
+                    stats.validation_count++;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            return;
+        }
+    }
+    
     while (!stop_flag.load()) {
         bool valid = validator.try_validate(tree, "validator thread");
         if (valid) {
@@ -375,8 +682,408 @@ void validator_thread_func(
     }
 }
 
-void run_stress_test(const TestConfig& config) {
+// Writer latency under a reader flood (Strategy 3: lookup_hybrid/insert_hybrid)
+struct WriterLatencyReport {
+    size_t writes = 0;
+    size_t reads = 0;
+    double p50_us = 0.0;
+    double p99_us = 0.0;
+    double max_us = 0.0;
+};
+
+// Readers spin on lookup_hybrid() while one writer times every insert_hybrid()
+// call; with an uncontended tree the insert itself is sub-microsecond, so the
+// latency is dominated by acquiring global_rw_lock.
+template <typename RWLock>
+WriterLatencyReport measure_hybrid_writer_latency(const TestConfig& config) {
+    rbt::RBTree<int, int, std::less<int>, RWLock> tree;
+    RandomGenerator init_rng(config.key_range, 42);
+    for (size_t i = 0; i < config.initial_elements; i++) {
+        tree.insert_hybrid(init_rng.random_key(), init_rng.random_value());
+    }
+
+    std::atomic<bool> stop_flag(false);
+    std::atomic<size_t> total_reads{0};
+    std::vector<double> latencies_us;
+
+    std::vector<std::thread> readers;
+    for (size_t i = 0; i < config.num_reader_threads; i++) {
+        readers.emplace_back([&, i] {
+            RandomGenerator rng(config.key_range, i + 3000);
+            size_t ops = 0;
+            while (!stop_flag.load(std::memory_order_relaxed)) {
+                tree.lookup_hybrid(rng.random_key());
+                ops++;
+            }
+            total_reads += ops;
+        });
+    }
+
+    std::thread writer([&] {
+        RandomGenerator rng(config.key_range, 4000);
+        while (!stop_flag.load(std::memory_order_relaxed)) {
+            int key = rng.random_key();
+            int val = rng.random_value();
+            auto t0 = std::chrono::steady_clock::now();
+            tree.insert_hybrid(key, val);
+            auto t1 = std::chrono::steady_clock::now();
+            latencies_us.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+        }
+    });
+
+    std::this_thread::sleep_for(config.test_duration);
+    stop_flag.store(true);
+    writer.join();
+    for (auto& t : readers) {
+        t.join();
+    }
+
+    std::sort(latencies_us.begin(), latencies_us.end());
+    WriterLatencyReport report;
+    report.writes = latencies_us.size();
+    report.reads = total_reads.load();
+    report.p50_us = percentile(latencies_us, 50.0);
+    report.p99_us = percentile(latencies_us, 99.0);
+    report.max_us = latencies_us.empty() ? 0.0 : latencies_us.back();
+    return report;
+}
+
+void print_writer_latency(const char* policy, const WriterLatencyReport& r) {
+    std::cout << "- " << std::left << std::setw(18) << policy << std::right
+              << " writes=" << r.writes << " reads=" << r.reads
+              << std::fixed << std::setprecision(2)
+              << " | writer latency us: p50=" << r.p50_us
+              << ", p99=" << r.p99_us << ", max=" << r.max_us << "\n";
+}
+
+// Compare writer wait with the default std::shared_mutex (before) and the
+// phase-fair policy (after) under the same reader flood.
+void run_writer_starvation_test(const TestConfig& config) {
+    std::cout << "Starting writer starvation test with configuration:\n"
+              << "- Reader threads: " << config.num_reader_threads << " (lookup_hybrid)\n"
+              << "- Writer threads: 1 (insert_hybrid)\n"
+              << "- Initial elements: " << config.initial_elements << "\n"
+              << "- Key range: " << config.key_range << "\n"
+              << "- Test duration: " << config.test_duration.count() << " seconds per lock policy\n";
+
+    auto before = measure_hybrid_writer_latency<std::shared_mutex>(config);
+    print_writer_latency("std::shared_mutex", before);
+    auto after = measure_hybrid_writer_latency<rbt::PhaseFairRWLock>(config);
+    print_writer_latency("PhaseFairRWLock", after);
+
+    std::cout << "Writer p99 acquisition latency: " << std::fixed << std::setprecision(2)
+              << before.p99_us << " us -> " << after.p99_us << " us\n";
+}
+
+void print_hot_cache_stats(const rbt::HotCacheStats& s) {
+    std::cout << "Hot-key cache: hits=" << s.hits << " misses=" << s.misses
+              << " fills=" << s.fills << " invalidations=" << s.invalidations
+              << std::fixed << std::setprecision(1) << " (hit rate " << 100.0 * s.hit_rate() << "%)\n";
+}
+
+void print_negative_filter_stats(const rbt::NegativeFilterStats& s) {
+    std::cout << "Negative filter: keys=" << s.keys << " design=" << s.design_keys
+              << " rebuilds=" << s.rebuilds << std::fixed << std::setprecision(2)
+              << " (estimated false-positive rate " << 100.0 * s.estimated_fpr << "%)\n";
+}
+
+void print_memory_stats(const rbt::MemoryStats& m) {
+    std::cout << "Memory: nodes=" << m.nodes << " bytes/node=" << m.bytes_per_node()
+              << " (payload " << m.payload_bytes << ", locks " << m.lock_bytes << ", links " << m.link_bytes
+              << ", other " << m.other_bytes << ", padding " << m.padding_bytes
+              << ", allocator " << m.allocator_slack << ") total=" << m.total_bytes() / 1024 << " KiB\n";
+}
+
+void print_shape_stats(const rbt::ShapeStats& s) {
+    std::cout << "Shape: nodes=" << s.nodes << " height=" << s.height << " black-height=" << s.black_height
+              << std::fixed << std::setprecision(2) << " mean depth=" << s.mean_depth()
+              << " (log2 n=" << std::log2(double(s.nodes) + 1.0) << ") imbalance=" << s.imbalance()
+              << " chunks=" << s.chunks << "\n";
+}
+
+void print_op_stats(const rbt::OpStats& s) {
+    auto locks = [](const char* name, const rbt::LockCounts& c) {
+        std::cout << "  " << std::left << std::setw(16) << name << std::right
+                  << " uncontended=" << c.uncontended << " contended=" << c.contended
+                  << std::fixed << std::setprecision(2) << " (" << 100.0 * c.contended_fraction() << "%)\n";
+    };
+    std::cout << "Operation counters:\n"
+              << "  rotations        left=" << s.left_rotations << " right=" << s.right_rotations << "\n"
+              << "  insert_fixup     iterations=" << s.insert_fixup_iterations << " cases="
+              << s.insert_cases[0] << "/" << s.insert_cases[1] << "/" << s.insert_cases[2] << "\n"
+              << "  delete_fixup     iterations=" << s.delete_fixup_iterations << " cases="
+              << s.delete_cases[0] << "/" << s.delete_cases[1] << "/" << s.delete_cases[2] << "/"
+              << s.delete_cases[3] << "\n"
+              << "  lookups          " << s.lookups << std::fixed << std::setprecision(2)
+              << " (mean path " << s.mean_lookup_depth() << " nodes)\n";
+    locks("writers_mutex", s.writers_mutex);
+    locks("global_rw_lock", s.global_rw_lock);
+    locks("Node::rw", s.node_latch);
+}
+
+struct LookupReport {
+    double lookups_per_sec = 0.0;
+    rbt::HotCacheStats cache;
+    rbt::NegativeFilterStats filter;
+    bool coherent = true;       // lookup() agrees with the tree for every key afterwards
+};
+
+// lookup() throughput with the front structures selected by `front`
+// (hot_cache_sets / negative_filter; all off for the baseline). One writer
+// inserts / erases keys from the readers' distribution, so invalidation and
+// filter maintenance are exercised on exactly the keys being looked up.
+// initial_elements >= key_range preloads every key.
+LookupReport measure_lookups(const TestConfig& config, const TestConfig& front) {
+    rbt::RBTree<int, int> tree;
+    if (front.hot_cache_sets > 0) tree.enable_hot_cache(front.hot_cache_sets);
+    if (config.initial_elements >= config.key_range) {
+        for (size_t k = 0; k < config.key_range; k++) {
+            tree.insert(static_cast<int>(k), static_cast<int>(k));
+        }
+    } else {
+        ReferenceMap reference;
+        initialize_tree(tree, reference, config);
+    }
+    if (front.negative_filter) tree.enable_negative_filter();
+
+    std::atomic<bool> stop_flag(false);
+    std::atomic<size_t> total_reads(0);
+    std::vector<std::thread> readers;
+    for (size_t i = 0; i < config.num_reader_threads; i++) {
+        readers.emplace_back([&, i] {
+            RandomGenerator rng(config.key_range, i + 5000, config.zipf_theta);
+            size_t ops = 0;
+            while (!stop_flag.load(std::memory_order_relaxed)) {
+                tree.lookup(rng.random_key());
+                ops++;
+            }
+            total_reads += ops;
+        });
+    }
+    std::thread writer([&] {
+        RandomGenerator rng(config.key_range, 6000, config.zipf_theta);
+        while (!stop_flag.load(std::memory_order_relaxed)) {
+            int key = rng.random_key();
+            if (rng.random_probability() < config.insert_ratio) tree.insert(key, rng.random_value());
+            else tree.erase(key);
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(config.test_duration);
+    stop_flag.store(true);
+    writer.join();
+    for (auto& t : readers) t.join();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    LookupReport report;
+    report.lookups_per_sec = total_reads.load() / secs;
+    report.cache = tree.hot_cache_stats();
+    report.filter = tree.negative_filter_stats();
+    for (size_t k = 0; k < config.key_range; k++) {
+        int key = static_cast<int>(k);
+        if (tree.lookup(key) != tree.lookup_simple(key)) report.coherent = false;
+    }
+    return report;
+}
+
+void run_hot_cache_test(const TestConfig& config) {
+    std::cout << "Starting hot-key cache test with configuration:\n"
+              << "- Reader threads: " << config.num_reader_threads << " (lookup)\n"
+              << "- Writer threads: 1 (insert ratio " << config.insert_ratio << ", same skew)\n"
+              << "- Key range: " << config.key_range << " (all present), zipf theta " << config.zipf_theta << "\n"
+              << "- Cache sets: " << config.hot_cache_sets << "\n"
+              << "- Test duration: " << config.test_duration.count() << " seconds per run\n";
+
+    auto before = measure_lookups(config, TestConfig{});
+    TestConfig front;
+    front.hot_cache_sets = config.hot_cache_sets;
+    auto after = measure_lookups(config, front);
+    print_hot_cache_stats(after.cache);
+    std::cout << "Zipfian lookup throughput: " << std::fixed << std::setprecision(0)
+              << before.lookups_per_sec << " ops/s -> " << after.lookups_per_sec << " ops/s\n"
+              << "Cached lookups match the tree: " << (after.coherent && before.coherent ? "PASSED" : "FAILED") << "\n";
+}
+
+void run_negative_filter_test(const TestConfig& config) {
+    std::cout << "Starting negative filter test with configuration:\n"
+              << "- Reader threads: " << config.num_reader_threads << " (lookup)\n"
+              << "- Writer threads: 1 (insert ratio " << config.insert_ratio << ")\n"
+              << "- Initial elements: " << config.initial_elements << " of key range " << config.key_range << "\n"
+              << "- Test duration: " << config.test_duration.count() << " seconds per run\n";
+
+    auto before = measure_lookups(config, TestConfig{});
+    TestConfig front;
+    front.negative_filter = true;
+    auto after = measure_lookups(config, front);
+    print_negative_filter_stats(after.filter);
+    std::cout << "Miss-heavy lookup throughput: " << std::fixed << std::setprecision(0)
+              << before.lookups_per_sec << " ops/s -> " << after.lookups_per_sec << " ops/s\n"
+              << "Filtered lookups match the tree: " << (after.coherent && before.coherent ? "PASSED" : "FAILED") << "\n";
+}
+
+// clear_async() while writers take the Strategy 3 path: erase_hybrid() and the
+// background teardown thread both drive the tree's epoch reclaimer
+void run_clear_async_test(const TestConfig& config) {
+    std::cout << "Starting clear_async test with configuration:\n"
+              << "- Reader threads: " << config.num_reader_threads << " (lookup_hybrid)\n"
+              << "- Writer threads: " << config.num_writer_threads << " (insert_hybrid/erase_hybrid)\n"
+              << "- Key range: " << config.key_range << "\n"
+              << "- Test duration: " << config.test_duration.count() << " seconds\n";
+
+    rbt::RBTree<int, int> tree;
+    std::atomic<bool> stop_flag(false);
+    std::atomic<size_t> total_writes(0);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < config.num_writer_threads; i++) {
+        threads.emplace_back([&, i] {
+            RandomGenerator rng(config.key_range, i + 9000);
+            size_t ops = 0;
+            while (!stop_flag.load(std::memory_order_relaxed)) {
+                int key = rng.random_key();
+                if (rng.random_probability() < config.insert_ratio) tree.insert_hybrid(key, rng.random_value());
+                else tree.erase_hybrid(key);
+                ops++;
+            }
+            total_writes += ops;
+        });
+    }
+    for (size_t i = 0; i < config.num_reader_threads; i++) {
+        threads.emplace_back([&, i] {
+            RandomGenerator rng(config.key_range, i + 9500);
+            while (!stop_flag.load(std::memory_order_relaxed)) tree.lookup_hybrid(rng.random_key());
+        });
+    }
+
+    size_t clears = 0;
+    auto deadline = std::chrono::steady_clock::now() + config.test_duration;
+    while (std::chrono::steady_clock::now() < deadline) {
+        tree.clear_async();
+        clears++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    stop_flag.store(true);
+    for (auto& t : threads) t.join();
+
+    bool valid = tree.validate();
+    std::cout << clears << " clear_async() calls during " << total_writes << " hybrid writes\n"
+              << "Final tree validation: " << (valid ? "PASSED" : "FAILED") << "\n";
+}
+
+// Ordered navigation under churn: readers check that every bound query result
+// satisfies its bound while writers insert / erase; once quiescent, every query
+// (both families) is compared against the sorted key set for the whole range.
+void run_navigation_test(const TestConfig& config) {
+    std::cout << "Starting ordered navigation test with configuration:\n"
+              << "- Reader threads: " << config.num_reader_threads << " (floor/ceiling/predecessor/successor/min/max)\n"
+              << "- Writer threads: " << config.num_writer_threads << "\n"
+              << "- Initial elements: " << config.initial_elements << " of key range " << config.key_range << "\n"
+              << "- Test duration: " << config.test_duration.count() << " seconds\n";
+
+    rbt::RBTree<int, int> tree;
+    ReferenceMap reference;
+    initialize_tree(tree, reference, config);
+
+    std::atomic<bool> stop_flag(false);
+    std::atomic<size_t> total_queries(0), violations(0);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < config.num_reader_threads; i++) {
+        threads.emplace_back([&, i] {
+            RandomGenerator rng(config.key_range, i + 7000);
+            size_t ops = 0, bad = 0;
+            while (!stop_flag.load(std::memory_order_relaxed)) {
+                int key = rng.random_key();
+                switch (ops % 6) {
+                case 0: if (auto e = tree.floor(key); e && e->first > key) bad++; break;
+                case 1: if (auto e = tree.ceiling(key); e && e->first < key) bad++; break;
+                case 2: if (auto e = tree.predecessor(key); e && e->first >= key) bad++; break;
+                case 3: if (auto e = tree.successor(key); e && e->first <= key) bad++; break;
+                case 4: if (auto e = tree.min(); e && (e->first < 0 || e->first >= static_cast<int>(config.key_range))) bad++; break;
+                default: if (auto e = tree.max(); e && (e->first < 0 || e->first >= static_cast<int>(config.key_range))) bad++; break;
+                }
+                ops++;
+            }
+            total_queries += ops;
+            violations += bad;
+        });
+    }
+    for (size_t i = 0; i < config.num_writer_threads; i++) {
+        threads.emplace_back([&, i] {
+            RandomGenerator rng(config.key_range, i + 8000);
+            while (!stop_flag.load(std::memory_order_relaxed)) {
+                int key = rng.random_key();
+                if (rng.random_probability() < config.insert_ratio) tree.insert(key, rng.random_value());
+                else tree.erase(key);
+            }
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(config.test_duration);
+    stop_flag.store(true);
+    for (auto& t : threads) t.join();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<int> keys;                  // Sorted live keys
+    for (size_t k = 0; k < config.key_range; k++) {
+        if (tree.lookup(static_cast<int>(k))) keys.push_back(static_cast<int>(k));
+    }
+    auto key_of = [](const auto& e) { return e ? e->first : -1; };
+    bool exact = key_of(tree.min()) == (keys.empty() ? -1 : keys.front()) &&
+                 key_of(tree.max()) == (keys.empty() ? -1 : keys.back());
+    for (int q = -1; q <= static_cast<int>(config.key_range) && exact; q++) {
+        auto ge = std::lower_bound(keys.begin(), keys.end(), q);
+        auto gt = std::upper_bound(keys.begin(), keys.end(), q);
+        int want_ge = ge == keys.end() ? -1 : *ge;
+        int want_gt = gt == keys.end() ? -1 : *gt;
+        int want_le = gt == keys.begin() ? -1 : *(gt - 1);
+        int want_lt = ge == keys.begin() ? -1 : *(ge - 1);
+        exact = key_of(tree.lower_bound(q)) == want_ge && key_of(tree.lower_bound_hybrid(q)) == want_ge &&
+                key_of(tree.upper_bound(q)) == want_gt && key_of(tree.upper_bound_hybrid(q)) == want_gt &&
+                key_of(tree.floor(q)) == want_le && key_of(tree.floor_hybrid(q)) == want_le &&
+                key_of(tree.predecessor(q)) == want_lt && key_of(tree.predecessor_hybrid(q)) == want_lt;
+    }
+
+    std::cout << "Navigation queries: " << total_queries.load() << " (" << std::fixed << std::setprecision(0)
+              << total_queries.load() / secs << " ops/s), bound violations: " << violations.load() << "\n"
+              << "Bounds under churn: " << (violations.load() == 0 ? "PASSED" : "FAILED") << "\n"
+              << "Quiescent bounds match sorted keys: " << (exact ? "PASSED" : "FAILED") << "\n"
+              << "Tree validation: " << (tree.validate() ? "PASSED" : "FAILED") << "\n";
+}
+
+// Outcome of one run_stress_test() / run_ycsb_test() call; the command-line
+// driver writes these out as JSON Lines or CSV
+struct RunResult {
+    std::string scenario;
+    std::string mode;                 // "stress" or "ycsb"
+    std::string engine;
+    TestConfig config;
+    double runtime_ms = 0.0;
+    size_t lookups = 0;
+    size_t lookup_hits = 0;
+    size_t inserts = 0;
+    size_t updates = 0;               // YCSB update / read-modify-write
+    size_t deletes = 0;
+    size_t delete_hits = 0;
+    size_t scans = 0;
+    double reader_ops_per_sec = 0.0;  // Mean per reader thread
+    double writer_ops_per_sec = 0.0;  // Mean per writer thread
+    double total_ops_per_sec = 0.0;
+    double read_p50_us = 0.0;         // Latency percentiles of the sampled
+    double read_p99_us = 0.0;         // operations (stress mode only)
+    double read_max_us = 0.0;
+    double write_p50_us = 0.0;
+    double write_p99_us = 0.0;
+    double write_max_us = 0.0;
+    size_t validations = 0;
+    bool passed = false;
+};
+
+template <typename Tree = rbt::RBTree<int, int>>
+RunResult run_stress_test(const TestConfig& config) {
     std::cout << "Starting stress test with configuration:\n"
+              << "- Engine: " << engine_name<Tree>() << "\n"
               << "- Reader threads: " << config.num_reader_threads << "\n"
               << "- Writer threads: " << config.num_writer_threads << "\n"
               << "- Initial elements: " << config.initial_elements << "\n"
@@ -384,13 +1091,37 @@ void run_stress_test(const TestConfig& config) {
               << "- Key range: " << config.key_range << "\n"
               << "- Insert ratio: " << config.insert_ratio << "\n"
               << "- Test duration: " << config.test_duration.count() << " seconds\n";
+    if (config.zipf_theta > 0.0) std::cout << "- Zipf theta: " << config.zipf_theta << "\n";
+    if (config.key_distribution) {
+        std::cout << "- Key distribution: " << rbt::key_distribution_name(*config.key_distribution) << "\n";
+    }
+    if (config.validation_slice > 0) {
+        std::cout << "- Validation: validate_slice() of " << config.validation_slice << " nodes\n";
+    }
     
-    // Create RB tree and reference implementation
-    rbt::RBTree<int, int> tree;
+    RunResult result;
+    result.mode = "stress";
+    result.engine = engine_name<Tree>();
+    result.config = config;
+    
+    // Create tree and reference implementation
+    Tree tree;
     ReferenceMap reference;
+    if constexpr (supports_hot_cache<Tree>::value) {
+        if (config.hot_cache_sets > 0) {
+            tree.enable_hot_cache(config.hot_cache_sets);
+            std::cout << "- Hot-key cache: " << config.hot_cache_sets << " sets\n";
+        }
+    }
     
     // Initialize tree with data
     initialize_tree(tree, reference, config);
+    if constexpr (supports_negative_filter<Tree>::value) {
+        if (config.negative_filter) {
+            tree.enable_negative_filter();
+            std::cout << "- Negative filter: enabled\n";
+        }
+    }
     
     // Create validator
     TreeValidator validator;
@@ -400,11 +1131,11 @@ void run_stress_test(const TestConfig& config) {
     std::cout << "Initial tree validation: " << (initial_valid ? "PASSED" : "FAILED") << "\n";
     if (!initial_valid) {
         std::cerr << "ERROR: Initial tree is invalid. Aborting test.\n";
-        return;
+        return result;
     }
     
     // Track statistics
-    TestStats stats;
+    TestStats stats(config.num_reader_threads, config.num_writer_threads);
     
     // Create thread stop flag
     std::atomic<bool> stop_flag(false);
@@ -415,21 +1146,23 @@ void run_stress_test(const TestConfig& config) {
     // Launch reader threads
     std::vector<std::thread> reader_threads;
     for (size_t i = 0; i < config.num_reader_threads; i++) {
-        reader_threads.emplace_back(reader_thread_func, 
+        reader_threads.emplace_back(reader_thread_func<Tree>, 
             std::ref(tree), std::ref(config), std::ref(stats),
             std::ref(validator), std::ref(stop_flag), i);
     }
     
     // Launch writer threads
+    std::vector<WriteLog> write_logs(config.num_writer_threads);
+    WriteClock write_clock{0};
     std::vector<std::thread> writer_threads;
     for (size_t i = 0; i < config.num_writer_threads; i++) {
-        writer_threads.emplace_back(writer_thread_func, 
-            std::ref(tree), std::ref(reference), std::ref(config), std::ref(stats),
+        writer_threads.emplace_back(writer_thread_func<Tree>, 
+            std::ref(tree), std::ref(write_logs[i]), std::ref(write_clock), std::ref(config), std::ref(stats),
             std::ref(validator), std::ref(stop_flag), i);
     }
     
     // Launch dedicated validator thread
-    std::thread validator_thread(validator_thread_func,
+    std::thread validator_thread(validator_thread_func<Tree>,
         std::ref(tree), std::ref(validator), std::ref(stop_flag),
         std::ref(config), std::ref(stats));
     
@@ -452,25 +1185,69 @@ void run_stress_test(const TestConfig& config) {
     // Calculate total runtime
     auto end_time = std::chrono::high_resolution_clock::now();
     stats.total_runtime = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    stats.collect();
+    std::sort(stats.read_latency_us.begin(), stats.read_latency_us.end());
+    std::sort(stats.write_latency_us.begin(), stats.write_latency_us.end());
     
     // Final validation
     std::cout << "Performing final tree validation...\n";
     bool final_valid = tree.validate();
     std::cout << "Final tree validation: " << (final_valid ? "PASSED" : "FAILED") << "\n";
+    if constexpr (supports_parallel_validation<Tree>::value) {
+        bool parallel_valid = tree.validate_parallel(4);
+        std::cout << "Parallel tree validation: " << (parallel_valid ? "PASSED" : "FAILED") << "\n";
+        final_valid = final_valid && parallel_valid;
+    }
     
     // Verify against reference implementation if requested
     bool comparison_valid = true;
-    if (config.verify_results) {
+    if (config.verify_results && !std::is_same_v<Tree, NullTree>) {
         std::cout << "Verifying tree against reference implementation...\n";
-        comparison_valid = reference.compare_with_tree(tree);
+        comparison_valid = reference.compare_with_tree(tree, write_logs);
         std::cout << "Tree comparison with reference: " << (comparison_valid ? "PASSED" : "FAILED") << "\n";
     }
     
     // Print statistics
     stats.print();
+    if constexpr (supports_hot_cache<Tree>::value) {
+        if (config.hot_cache_sets > 0) print_hot_cache_stats(tree.hot_cache_stats());
+    }
+    if constexpr (supports_negative_filter<Tree>::value) {
+        if (config.negative_filter) print_negative_filter_stats(tree.negative_filter_stats());
+    }
+    if constexpr (supports_memory_stats<Tree>::value) print_memory_stats(tree.memory_stats());
+    if constexpr (supports_shape_stats<Tree>::value) print_shape_stats(tree.shape_stats());
+    if constexpr (supports_op_stats<Tree>::value) {
+        if (tree.op_stats().enabled) print_op_stats(tree.op_stats());
+    }
+    if constexpr (supports_lock_profile<Tree>::value) {
+        if (!tree.lock_profile().empty()) tree.dump_lock_profile(std::cout);
+    }
+    
+    auto mean = [](const std::vector<double>& v) {
+        return v.empty() ? 0.0 : std::accumulate(v.begin(), v.end(), 0.0) / v.size();
+    };
+    auto max_of = [](const std::vector<double>& sorted) { return sorted.empty() ? 0.0 : sorted.back(); };
+    result.runtime_ms = static_cast<double>(stats.total_runtime.count());
+    result.lookups = stats.total_lookups;
+    result.lookup_hits = stats.successful_lookups;
+    result.inserts = stats.total_inserts;
+    result.deletes = stats.total_deletes;
+    result.delete_hits = stats.successful_deletes;
+    result.reader_ops_per_sec = mean(stats.reader_throughput);
+    result.writer_ops_per_sec = mean(stats.writer_throughput);
+    result.total_ops_per_sec = (result.lookups + result.inserts + result.deletes) / std::max(result.runtime_ms / 1000.0, 0.001);
+    result.read_p50_us = percentile(stats.read_latency_us, 50.0);
+    result.read_p99_us = percentile(stats.read_latency_us, 99.0);
+    result.read_max_us = max_of(stats.read_latency_us);
+    result.write_p50_us = percentile(stats.write_latency_us, 50.0);
+    result.write_p99_us = percentile(stats.write_latency_us, 99.0);
+    result.write_max_us = max_of(stats.write_latency_us);
+    result.validations = stats.validation_count;
+    result.passed = final_valid && comparison_valid && !validator.has_validation_failed();
     
     // Final result
-    if (final_valid && comparison_valid && !validator.has_validation_failed()) {
+    if (result.passed) {
         std::cout << "\n==== STRESS TEST PASSED ====\n";
     } else {
         std::cout << "\n==== STRESS TEST FAILED ====\n";
@@ -478,6 +1255,87 @@ void run_stress_test(const TestConfig& config) {
         if (!comparison_valid) std::cout << "  - Tree comparison with reference failed\n";
         if (validator.has_validation_failed()) std::cout << "  - At least one validation during test failed\n";
     }
+    return result;
+}
+
+// YCSB core workload config.ycsb_workload (ycsb_workload.cpp) on
+// initial_elements ordered records, one client per configured reader and
+// writer thread. No record is ever erased, so afterwards every key in
+// [0, records) must be present and the tree valid.
+template <typename Tree = rbt::RBTree<int, int>>
+RunResult run_ycsb_test(const TestConfig& config) {
+    RunResult result;
+    result.mode = "ycsb";
+    result.engine = engine_name<Tree>();
+    result.config = config;
+    rbt::YcsbWorkload workload = rbt::YcsbWorkload::preset(config.ycsb_workload);
+    if (config.key_distribution) workload.distribution = *config.key_distribution;
+    size_t clients = config.num_reader_threads + config.num_writer_threads;
+    std::cout << "YCSB-" << workload.name << " (" << workload.description << ", "
+              << rbt::key_distribution_name(workload.distribution) << " keys): "
+              << config.initial_elements << " records, " << clients << " clients, "
+              << config.test_duration.count() << " seconds\n";
+    if (workload.proportion[static_cast<size_t>(rbt::YcsbOp::SCAN)] > 0.0 && !rbt::has_ordered_scan<Tree>::value) {
+        std::cout << "  Skipped: " << engine_name<Tree>() << " has no ordered scan\n";
+        return result;      // Not run, so not passed (check_run() keeps the CLI from getting here)
+    }
+    
+    Tree tree;
+    for (size_t i = 0; i < config.initial_elements; i++) {
+        tree.insert(static_cast<int>(i), static_cast<int>(i));
+    }
+    rbt::YcsbResult r = rbt::run_ycsb(tree, workload, config.initial_elements, clients, config.test_duration,
+                                      config.zipf_theta > 0.0 ? config.zipf_theta : 0.99);
+    
+    std::cout << "  " << std::fixed << std::setprecision(0) << r.ops_per_sec() << " ops/s:";
+    for (size_t i = 0; i < static_cast<size_t>(rbt::YcsbOp::COUNT); i++) {
+        if (r.ops[i]) std::cout << " " << rbt::ycsb_op_name(static_cast<rbt::YcsbOp>(i)) << "=" << r.ops[i];
+    }
+    size_t reads = r.ops[static_cast<size_t>(rbt::YcsbOp::READ)];
+    size_t scans = r.ops[static_cast<size_t>(rbt::YcsbOp::SCAN)];
+    std::cout << std::setprecision(2);
+    if (reads) std::cout << " | read hits " << 100.0 * r.read_hits / reads << "%";
+    if (scans) std::cout << " | " << double(r.scanned) / scans << " entries/scan";
+    std::cout << "\n";
+    
+    size_t missing = 0;
+    for (size_t k = 0; k < r.records; k++) {
+        if (!tree.lookup(static_cast<int>(k))) missing++;
+    }
+    bool ok = missing == 0 && tree.validate();
+    std::cout << "  Records [0, " << r.records << ") present and tree valid: " << (ok ? "PASSED" : "FAILED");
+    if (missing) std::cout << " (" << missing << " missing)";
+    std::cout << "\n";
+    
+    auto count = [&r](rbt::YcsbOp op) { return r.ops[static_cast<size_t>(op)]; };
+    result.runtime_ms = r.seconds * 1000.0;
+    result.lookups = reads;
+    result.lookup_hits = r.read_hits;
+    result.inserts = count(rbt::YcsbOp::INSERT);
+    result.updates = count(rbt::YcsbOp::UPDATE) + count(rbt::YcsbOp::READ_MODIFY_WRITE);
+    result.scans = scans;
+    result.total_ops_per_sec = r.ops_per_sec();
+    result.passed = ok;
+    return result;
+}
+
+// The same workload on NullTree, then on RBTree. The null run is the
+// harness's own ceiling; the RBTree per-thread throughput as a share of it is
+// roughly the fraction of each RBTree operation's time spent in the harness.
+void run_harness_overhead_test(const TestConfig& config) {
+    RunResult harness = run_stress_test<NullTree>(config);
+    RunResult tree = run_stress_test(config);
+    auto share = [](double tree_ops, double harness_ops) {
+        return harness_ops > 0.0 ? 100.0 * tree_ops / harness_ops : 0.0;
+    };
+    std::cout << "\nHarness overhead (ops/sec per thread, null engine vs " << tree.engine << "):\n"
+              << std::fixed << std::setprecision(0)
+              << "  readers: " << harness.reader_ops_per_sec << " vs " << tree.reader_ops_per_sec
+              << std::setprecision(1) << " -> harness ~" << share(tree.reader_ops_per_sec, harness.reader_ops_per_sec)
+              << "% of lookup time\n" << std::setprecision(0)
+              << "  writers: " << harness.writer_ops_per_sec << " vs " << tree.writer_ops_per_sec
+              << std::setprecision(1) << " -> harness ~" << share(tree.writer_ops_per_sec, harness.writer_ops_per_sec)
+              << "% of insert/erase time\n" << std::setprecision(2);
 }
 
 // Test variations with different configurations
@@ -519,9 +1377,556 @@ void run_all_tests() {
         config.test_duration = std::chrono::seconds(10);
         run_stress_test(config);
     }
+    
+    // Same default workload on the B+tree engine (OLC, SIMD in-node search)
+    {
+        std::cout << "\n======= Running B+tree engine test =======\n";
+        TestConfig config;
+        config.test_duration = std::chrono::seconds(15);
+        run_stress_test<rbt::BPlusTree<int, int>>(config);
+    }
+    
+    // Skewed keys with the hot-key front cache: correctness, then throughput
+    {
+        std::cout << "\n======= Running zipfian hot-key cache test =======\n";
+        TestConfig config;
+        config.zipf_theta = 0.99;
+        config.hot_cache_sets = 1024;
+        config.initial_elements = config.key_range;     // Hot keys present, so hits are cacheable
+        config.insert_ratio = 0.9;
+        config.test_duration = std::chrono::seconds(10);
+        run_stress_test(config);
+        config.test_duration = std::chrono::seconds(5);
+        run_hot_cache_test(config);
+    }
+    
+    // Miss-heavy default workload with the negative-lookup filter
+    {
+        std::cout << "\n======= Running negative filter test =======\n";
+        TestConfig config;
+        config.negative_filter = true;
+        config.test_duration = std::chrono::seconds(10);
+        run_stress_test(config);
+        config.test_duration = std::chrono::seconds(5);
+        run_negative_filter_test(config);
+    }
+    
+    // Continuous invariant checking on a larger tree without whole-tree stalls
+    {
+        std::cout << "\n======= Running incremental validation test =======\n";
+        TestConfig config;
+        config.initial_elements = 200000;
+        config.key_range = 400000;
+        config.validation_slice = 1024;
+        config.test_duration = std::chrono::seconds(10);
+        run_stress_test(config);
+    }
+    
+    // YCSB core workloads A-F, then A again with a contiguous hot key range
+    {
+        std::cout << "\n======= Running YCSB workload tests =======\n";
+        TestConfig config;
+        config.initial_elements = 100000;
+        config.num_reader_threads = 4;
+        config.num_writer_threads = 4;
+        config.test_duration = std::chrono::seconds(3);
+        for (char w : std::string("ABCDEF")) {
+            config.ycsb_workload = w;
+            run_ycsb_test(config);
+        }
+        config.ycsb_workload = 'A';
+        config.key_distribution = rbt::KeyDistribution::HOTSPOT;
+        run_ycsb_test(config);
+    }
+    
+    // Background teardown racing hybrid writers on the reclaimer
+    {
+        std::cout << "\n======= Running clear_async test =======\n";
+        TestConfig config;
+        config.num_reader_threads = 2;
+        config.num_writer_threads = 2;
+        config.key_range = 20000;
+        config.insert_ratio = 0.7;
+        config.test_duration = std::chrono::seconds(3);
+        run_clear_async_test(config);
+    }
+    
+    // Bound queries and cached extremes against concurrent writers
+    {
+        std::cout << "\n======= Running ordered navigation test =======\n";
+        TestConfig config;
+        config.num_reader_threads = 4;
+        config.num_writer_threads = 2;
+        config.key_range = 20000;
+        config.test_duration = std::chrono::seconds(5);
+        run_navigation_test(config);
+    }
+    
+    // Writer starvation under a reader flood (Strategy 3 lock policies)
+    {
+        std::cout << "\n======= Running writer starvation test =======\n";
+        TestConfig config;
+        config.num_reader_threads = 16;
+        config.num_writer_threads = 1;
+        config.test_duration = std::chrono::seconds(5);
+        run_writer_starvation_test(config);
+    }
+    
+    // What the harness itself costs per operation (no operation cap, so the
+    // null engine runs as long as the tree)
+    {
+        std::cout << "\n======= Running harness overhead test =======\n";
+        TestConfig config;
+        config.num_reader_threads = 4;
+        config.num_writer_threads = 4;
+        config.operations_per_thread = std::numeric_limits<size_t>::max();
+        config.test_duration = std::chrono::seconds(3);
+        run_harness_overhead_test(config);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Command-line / config-file driven runs
+// ---------------------------------------------------------------------------
+// With no arguments main() runs run_all_tests(). Otherwise each --key=value
+// sets a TestConfig member by its field name (see --help), or one of:
+//   --mode=stress|ycsb          run_stress_test() (default) or run_ycsb_test()
+//   --engine=rbtree|bplus|null  tree under test; null = harness overhead only
+//   --name=NAME                 scenario label in the output records
+//   --config=FILE               scenarios from FILE; other options override them
+//   --format=text|json|csv      json = JSON Lines, one record per run
+//   --output=FILE               append the records to FILE instead of stdout
+// A comma-separated value ("--num_writer_threads=1,2,4") turns a scenario
+// into a matrix: one run per element of the cartesian product. With json or
+// csv records on stdout, the human-readable log moves to stderr.
+
+bool parse_value(const std::string& s, size_t& out) {
+    if (s.empty() || s.find_first_not_of("0123456789") != std::string::npos) return false;
+    try {
+        out = std::stoull(s);
+    } catch (const std::out_of_range&) {
+        return false;
+    }
+    return true;
+}
+
+bool parse_value(const std::string& s, double& out) {
+    std::istringstream in(s);
+    in >> out;
+    return !s.empty() && !in.fail() && in.eof();
+}
+
+bool parse_value(const std::string& s, bool& out) {
+    if (s == "1" || s == "true" || s == "yes" || s == "on") out = true;
+    else if (s == "0" || s == "false" || s == "no" || s == "off") out = false;
+    else return false;
+    return true;
+}
+
+bool parse_value(const std::string& s, std::chrono::seconds& out) {
+    size_t n = 0;
+    if (!parse_value(s, n)) return false;
+    out = std::chrono::seconds(n);
+    return true;
+}
+
+bool parse_value(const std::string& s, char& out) {
+    if (s.size() != 1) return false;
+    out = static_cast<char>(std::toupper(static_cast<unsigned char>(s[0])));
+    return true;
+}
+
+bool parse_value(const std::string& s, std::optional<rbt::KeyDistribution>& out) {
+    if (s.empty() || s == "default") {
+        out.reset();
+        return true;
+    }
+    for (auto d : {rbt::KeyDistribution::UNIFORM, rbt::KeyDistribution::ZIPFIAN, rbt::KeyDistribution::HOTSPOT,
+                   rbt::KeyDistribution::LATEST, rbt::KeyDistribution::SEQUENTIAL}) {
+        if (s == rbt::key_distribution_name(d)) {
+            out = d;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string format_value(size_t v) { return std::to_string(v); }
+std::string format_value(bool v) { return v ? "true" : "false"; }
+std::string format_value(std::chrono::seconds v) { return std::to_string(v.count()); }
+std::string format_value(char v) { return std::string(1, v); }
+std::string format_value(const std::optional<rbt::KeyDistribution>& v) {
+    return v ? rbt::key_distribution_name(*v) : "";
+}
+std::string format_value(double v) {
+    std::ostringstream out;
+    out << v;
+    return out.str();
+}
+
+// One TestConfig member: the same table drives option parsing, --help and
+// the config columns of the JSON / CSV records
+struct ConfigField {
+    const char* name;
+    const char* help;
+    std::function<bool(TestConfig&, const std::string&)> set;   // false = malformed value
+    std::function<std::string(const TestConfig&)> get;
+};
+
+template <typename T>
+ConfigField config_field(const char* name, T TestConfig::*member, const char* help) {
+    return {name, help,
+            [member](TestConfig& c, const std::string& s) { return parse_value(s, c.*member); },
+            [member](const TestConfig& c) { return format_value(c.*member); }};
+}
+
+const std::vector<ConfigField>& config_fields() {
+    static const std::vector<ConfigField> fields = {
+        config_field("num_reader_threads", &TestConfig::num_reader_threads, "reader threads (YCSB: clients)"),
+        config_field("num_writer_threads", &TestConfig::num_writer_threads, "writer threads (YCSB: clients)"),
+        config_field("initial_elements", &TestConfig::initial_elements, "elements inserted first (YCSB: records)"),
+        config_field("operations_per_thread", &TestConfig::operations_per_thread, "operation cap per thread"),
+        config_field("key_range", &TestConfig::key_range, "keys drawn from [0, key_range)"),
+        config_field("insert_ratio", &TestConfig::insert_ratio, "writer insert probability, rest erase"),
+        config_field("validate_periodically", &TestConfig::validate_periodically, "readers / writers validate too"),
+        config_field("validation_interval", &TestConfig::validation_interval, "operations between those validations"),
+        config_field("test_duration", &TestConfig::test_duration, "seconds"),
+        config_field("verify_results", &TestConfig::verify_results, "compare with the reference map at the end"),
+        config_field("zipf_theta", &TestConfig::zipf_theta, "key skew in [0, 1); 0 = uniform"),
+        config_field("key_distribution", &TestConfig::key_distribution,
+                     "uniform|zipfian|hotspot|latest|sequential; empty = default"),
+        config_field("ycsb_workload", &TestConfig::ycsb_workload, "YCSB preset A-F"),
+        config_field("hot_cache_sets", &TestConfig::hot_cache_sets, "RBTree hot-key cache sets; 0 = off"),
+        config_field("negative_filter", &TestConfig::negative_filter, "RBTree negative-lookup filter"),
+        config_field("validation_slice", &TestConfig::validation_slice, "> 0: validate_slice() nodes per slice"),
+    };
+    return fields;
+}
+
+// A fully resolved run
+struct RunSpec {
+    std::string name;
+    std::string mode = "stress";
+    std::string engine = "rbtree";
+    TestConfig config;
+};
+
+// Values stay strings until expansion; later settings of a key win
+struct Scenario {
+    std::string name;
+    std::vector<std::pair<std::string, std::string>> settings;
+};
+
+void apply_setting(RunSpec& run, const std::string& key, const std::string& value) {
+    if (key == "mode") {
+        if (value != "stress" && value != "ycsb") throw std::invalid_argument("mode must be stress or ycsb");
+        run.mode = value;
+        return;
+    }
+    if (key == "engine") {
+        if (value != "rbtree" && value != "bplus" && value != "null") {
+            throw std::invalid_argument("engine must be rbtree, bplus or null");
+        }
+        run.engine = value;
+        return;
+    }
+    for (const auto& field : config_fields()) {
+        if (key != field.name) continue;
+        if (!field.set(run.config, value)) {
+            throw std::invalid_argument("bad value '" + value + "' for " + key + " (" + field.help + ")");
+        }
+        return;
+    }
+    throw std::invalid_argument("unknown option '" + key + "'");
+}
+
+// Rejects what would otherwise trip an assert or divide by zero mid-run
+void check_run(const RunSpec& run) {
+    const TestConfig& c = run.config;
+    auto require = [&run](bool ok, const char* what) {
+        if (!ok) throw std::invalid_argument(run.name + ": " + what);
+    };
+    require(c.key_range >= 1 && c.key_range <= static_cast<size_t>(std::numeric_limits<int>::max()),
+            "key_range must be in [1, INT_MAX]");
+    require(c.validation_interval >= 1, "validation_interval must be at least 1");
+    require(c.zipf_theta >= 0.0 && c.zipf_theta < 1.0, "zipf_theta must be in [0, 1)");
+    require(c.insert_ratio >= 0.0 && c.insert_ratio <= 1.0, "insert_ratio must be in [0, 1]");
+    require(c.ycsb_workload >= 'A' && c.ycsb_workload <= 'F', "ycsb_workload must be one of A-F");
+    if (run.mode == "ycsb") {
+        require(run.engine != "null", "the null engine only runs in stress mode");
+        require(c.initial_elements >= 1, "ycsb needs initial_elements >= 1");
+        require(c.num_reader_threads + c.num_writer_threads >= 1, "ycsb needs at least one client thread");
+        bool scans = rbt::YcsbWorkload::preset(c.ycsb_workload).proportion[static_cast<size_t>(rbt::YcsbOp::SCAN)] > 0.0;
+        require(!(scans && run.engine == "bplus" && !rbt::has_ordered_scan<rbt::BPlusTree<int, int>>::value),
+                "the bplus engine has no ordered scan for this YCSB workload");
+    }
+}
+
+std::vector<std::string> split_list(const std::string& s) {
+    std::vector<std::string> out;
+    size_t begin = 0;
+    for (size_t comma; (comma = s.find(',', begin)) != std::string::npos; begin = comma + 1) {
+        out.push_back(s.substr(begin, comma - begin));
+    }
+    out.push_back(s.substr(begin));
+    return out;
+}
+
+std::string trim(const std::string& s) {
+    size_t begin = s.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) return "";
+    return s.substr(begin, s.find_last_not_of(" \t\r") - begin + 1);
 }
 
-int main() {
+// Cartesian product of the scenario's comma-separated values; each run is
+// named after the scenario plus the axes that vary
+std::vector<RunSpec> expand_scenario(const Scenario& scenario) {
+    std::vector<std::pair<std::string, std::vector<std::string>>> axes;
+    for (const auto& [key, value] : scenario.settings) {
+        auto it = std::find_if(axes.begin(), axes.end(), [&key = key](const auto& a) { return a.first == key; });
+        if (it != axes.end()) it->second = split_list(value);
+        else axes.emplace_back(key, split_list(value));
+    }
+    std::vector<RunSpec> runs(1);
+    runs[0].name = scenario.name;
+    for (const auto& [key, values] : axes) {
+        std::vector<RunSpec> next;
+        for (const RunSpec& base : runs) {
+            for (const std::string& value : values) {
+                RunSpec run = base;
+                apply_setting(run, key, trim(value));
+                if (values.size() > 1) run.name += " " + key + "=" + trim(value);
+                next.push_back(std::move(run));
+            }
+        }
+        runs.swap(next);
+    }
+    for (const RunSpec& run : runs) check_run(run);
+    return runs;
+}
+
+// `key = value` lines and `#` comments; every `[name]` header starts a new
+// scenario, and settings above the first header are shared by all of them
+std::vector<Scenario> load_scenarios(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::invalid_argument("cannot open config file " + path);
+    Scenario common{path, {}};
+    std::vector<Scenario> scenarios;
+    std::string line;
+    for (size_t line_no = 1; std::getline(in, line); line_no++) {
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+        if (line.front() == '[') {
+            if (line.back() != ']') throw std::invalid_argument(path + ":" + std::to_string(line_no) + ": unterminated [");
+            scenarios.push_back({trim(line.substr(1, line.size() - 2)), common.settings});
+            continue;
+        }
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) {
+            throw std::invalid_argument(path + ":" + std::to_string(line_no) + ": expected key = value");
+        }
+        Scenario& target = scenarios.empty() ? common : scenarios.back();
+        std::string key = trim(line.substr(0, eq));
+        std::replace(key.begin(), key.end(), '-', '_');
+        if (key == "name") target.name = trim(line.substr(eq + 1));
+        else target.settings.emplace_back(key, trim(line.substr(eq + 1)));
+    }
+    if (scenarios.empty()) scenarios.push_back(common);
+    return scenarios;
+}
+
+RunResult run_spec(const RunSpec& run) {
+    using BPlus = rbt::BPlusTree<int, int>;
+    bool bplus = run.engine == "bplus";
+    RunResult result;
+    if (run.engine == "null") result = run_stress_test<NullTree>(run.config);
+    else if (run.mode == "ycsb") result = bplus ? run_ycsb_test<BPlus>(run.config) : run_ycsb_test(run.config);
+    else result = bplus ? run_stress_test<BPlus>(run.config) : run_stress_test(run.config);
+    result.scenario = run.name;
+    return result;
+}
+
+// Metric columns shared by the JSON and CSV writers, in output order
+std::vector<std::pair<const char*, std::string>> result_columns(const RunResult& r) {
+    auto num = [](double v) {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(3) << v;
+        return out.str();
+    };
+    return {
+        {"runtime_ms", num(r.runtime_ms)},
+        {"lookups", std::to_string(r.lookups)},
+        {"lookup_hits", std::to_string(r.lookup_hits)},
+        {"inserts", std::to_string(r.inserts)},
+        {"updates", std::to_string(r.updates)},
+        {"deletes", std::to_string(r.deletes)},
+        {"delete_hits", std::to_string(r.delete_hits)},
+        {"scans", std::to_string(r.scans)},
+        {"reader_ops_per_sec", num(r.reader_ops_per_sec)},
+        {"writer_ops_per_sec", num(r.writer_ops_per_sec)},
+        {"total_ops_per_sec", num(r.total_ops_per_sec)},
+        {"read_p50_us", num(r.read_p50_us)},
+        {"read_p99_us", num(r.read_p99_us)},
+        {"read_max_us", num(r.read_max_us)},
+        {"write_p50_us", num(r.write_p50_us)},
+        {"write_p99_us", num(r.write_p99_us)},
+        {"write_max_us", num(r.write_max_us)},
+        {"validations", std::to_string(r.validations)},
+        {"passed", r.passed ? "true" : "false"},
+    };
+}
+
+std::string json_string(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += {'\\', c};
+        else if (static_cast<unsigned char>(c) < 0x20) out += ' ';
+        else out += c;
+    }
+    return out + "\"";
+}
+
+// Config values are untyped strings: numbers and booleans go out bare
+std::string json_value(const std::string& s) {
+    if (s.empty()) return "null";
+    if (s == "true" || s == "false") return s;
+    double d;
+    return parse_value(s, d) ? s : json_string(s);
+}
+
+std::string csv_field(const std::string& s) {
+    if (s.find_first_of(",\"\n") == std::string::npos) return s;
+    std::string out = "\"";
+    for (char c : s) out += c == '"' ? std::string("\"\"") : std::string(1, c);
+    return out + "\"";
+}
+
+void write_json(std::ostream& os, const RunResult& r) {
+    os << "{\"scenario\":" << json_string(r.scenario) << ",\"mode\":" << json_string(r.mode)
+       << ",\"engine\":" << json_string(r.engine) << ",\"config\":{";
+    const char* sep = "";
+    for (const auto& field : config_fields()) {
+        os << sep << "\"" << field.name << "\":" << json_value(field.get(r.config));
+        sep = ",";
+    }
+    os << "}";
+    for (const auto& [name, value] : result_columns(r)) os << ",\"" << name << "\":" << value;
+    os << "}\n";
+}
+
+void write_csv_header(std::ostream& os) {
+    os << "scenario,mode,engine";
+    for (const auto& field : config_fields()) os << "," << field.name;
+    for (const auto& column : result_columns(RunResult{})) os << "," << column.first;
+    os << "\n";
+}
+
+void write_csv(std::ostream& os, const RunResult& r) {
+    os << csv_field(r.scenario) << "," << r.mode << "," << r.engine;
+    for (const auto& field : config_fields()) os << "," << csv_field(field.get(r.config));
+    for (const auto& column : result_columns(r)) os << "," << column.second;
+    os << "\n";
+}
+
+void print_usage(std::ostream& os) {
+    TestConfig defaults;
+    os << "Usage: rbtree_stress_test                 run the built-in test suite\n"
+       << "       rbtree_stress_test [--key=value...] run the configured scenarios\n\n"
+       << "  --mode=stress|ycsb         [stress]\n"
+       << "  --engine=rbtree|bplus|null [rbtree]  null: no-op tree, harness overhead only\n"
+       << "  --name=NAME                [cli]\n"
+       << "  --config=FILE              scenarios: key = value lines, [name] headers\n"
+       << "  --format=text|json|csv     [text]\n"
+       << "  --output=FILE              append records here instead of stdout\n";
+    for (const auto& field : config_fields()) {
+        std::string option = std::string("  --") + field.name + "=";
+        os << std::left << std::setw(29) << option << std::setw(9) << ("[" + field.get(defaults) + "]")
+           << field.help << "\n";
+    }
+    os << std::right << "Comma-separated values run every combination, e.g. --num_writer_threads=1,2,4\n";
+}
+
+int run_cli(int argc, char** argv) {
+    std::string format = "text";
+    std::string output;
+    std::string config_file;
+    Scenario cli{"cli", {}};
+    bool named = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            print_usage(std::cout);
+            return 0;
+        }
+        if (arg.rfind("--", 0) != 0) throw std::invalid_argument("unexpected argument '" + arg + "'");
+        size_t eq = arg.find('=');
+        std::string key = arg.substr(2, eq == std::string::npos ? std::string::npos : eq - 2);
+        std::string value = eq == std::string::npos ? "true" : arg.substr(eq + 1);   // Bare --flag
+        std::replace(key.begin(), key.end(), '-', '_');
+        if (key == "format") format = value;
+        else if (key == "output") output = value;
+        else if (key == "config") config_file = value;
+        else if (key == "name") {
+            cli.name = value;
+            named = true;
+        } else {
+            cli.settings.emplace_back(key, value);
+        }
+    }
+    if (format != "text" && format != "json" && format != "csv") {
+        throw std::invalid_argument("format must be text, json or csv");
+    }
+    
+    std::vector<Scenario> scenarios = {cli};
+    if (!config_file.empty()) {
+        scenarios = load_scenarios(config_file);
+        for (Scenario& s : scenarios) {
+            s.settings.insert(s.settings.end(), cli.settings.begin(), cli.settings.end());
+            if (named) s.name = cli.name + " " + s.name;
+        }
+    }
+    std::vector<RunSpec> runs;
+    for (const Scenario& s : scenarios) {
+        for (RunSpec& run : expand_scenario(s)) runs.push_back(std::move(run));
+    }
+    
+    // Records go to --output, else stdout; the log then gives way to stderr
+    std::ofstream file;
+    bool header = format == "csv";
+    if (!output.empty()) {
+        header = header && std::ifstream(output).peek() == std::ifstream::traits_type::eof();
+        file.open(output, std::ios::app);
+        if (!file) throw std::invalid_argument("cannot open output file " + output);
+    }
+    std::ostream records(output.empty() ? std::cout.rdbuf() : file.rdbuf());
+    std::streambuf* log_buf = std::cout.rdbuf();
+    if (format != "text" && output.empty()) std::cout.rdbuf(std::cerr.rdbuf());
+    if (header) write_csv_header(records);
+    
+    size_t failed = 0;
+    for (size_t i = 0; i < runs.size(); i++) {
+        std::cout << "\n======= [" << i + 1 << "/" << runs.size() << "] " << runs[i].name << " =======\n";
+        RunResult result = run_spec(runs[i]);
+        if (!result.passed) failed++;
+        if (format == "json") write_json(records, result);
+        else if (format == "csv") write_csv(records, result);
+        records.flush();
+    }
+    std::cout << "\n" << runs.size() - failed << " of " << runs.size() << " runs passed\n";
+    std::cout.rdbuf(log_buf);
+    return failed == 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        try {
+            return run_cli(argc, argv);
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "error: " << e.what() << " (see --help)\n";
+            return 2;
+        }
+    }
+    
     std::cout << "==== Lock-Based RB-Tree Stress Test ====\n";
     
     // Set up hardware concurrency info
@@ -0,0 +1,388 @@
+/*═══════════════════════════════════════════════════════════════════════════════
+ * YCSB WORKLOADS - Key Distributions and Operation Mixes for the Harnesses
+ *═══════════════════════════════════════════════════════════════════════════════
+ *
+ * OVERVIEW:
+ * Shared by rbtree_stress_test.cpp and rbtree_benchmark.cpp so both drive
+ * the engines with the same traffic. Uniform random keys spread accesses
+ * evenly over the tree, which hides the cache locality (a hot upper tree
+ * and a few hot leaves) and the write contention that skewed production
+ * traffic produces. This file provides the YCSB core workloads
+ * (Cooper et al., SoCC 2010) over ordered integer records:
+ *
+ *   preset │ mix                               │ keys
+ *   ───────┼───────────────────────────────────┼───────────
+ *     A    │ 50% read, 50% update              │ zipfian
+ *     B    │ 95% read,  5% update              │ zipfian
+ *     C    │ 100% read                         │ zipfian
+ *     D    │ 95% read,  5% insert              │ latest
+ *     E    │ 95% scan,  5% insert              │ zipfian
+ *     F    │ 50% read, 50% read-modify-write   │ zipfian
+ *
+ * KEY DISTRIBUTIONS (KeyChooser, over record indices [0, records)):
+ * - UNIFORM:    every record equally likely
+ * - ZIPFIAN:    rank r has weight 1/r^theta (Gray et al.); ranks are
+ *               scattered over the key space, so hot keys are not tree
+ *               neighbours
+ * - HOTSPOT:    hot_ops of the accesses go to the lowest hot_fraction of
+ *               the keys (one contiguous hot subtree), the rest uniform
+ * - LATEST:     zipfian over recency: the most recently inserted record is
+ *               the hottest, its neighbours next
+ * - SEQUENTIAL: each chooser walks the keys in order and wraps around
+ *
+ * Records are keys 0..records-1 in key order; inserts append the next
+ * index, so new keys always land at the right edge of the tree (as with
+ * timestamp or auto-increment keys).
+ *═══════════════════════════════════════════════════════════════════════════════*/
+
+// Header-style: included by rbtree_stress_test.cpp and rbtree_benchmark.cpp.
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace rbt
+{
+    enum class KeyDistribution
+    {
+        UNIFORM,
+        ZIPFIAN,
+        HOTSPOT,
+        LATEST,
+        SEQUENTIAL
+    };
+
+    inline const char *key_distribution_name(KeyDistribution d)
+    {
+        static const char *const names[] = {"uniform", "zipfian", "hotspot", "latest", "sequential"};
+        return names[static_cast<size_t>(d)];
+    }
+
+    /*═══════════════════════════════════════════════════════════════════════════
+     * ZipfianGenerator - Rank Sampling in O(1) after O(n) Setup
+     *═══════════════════════════════════════════════════════════════════════════
+     * Gray et al., "Quickly Generating Billion-Record Synthetic Databases"
+     * (SIGMOD 1994), as used by YCSB. Immutable after construction, so one
+     * instance can be shared by all threads, each passing its own uniform u.
+     *═══════════════════════════════════════════════════════════════════════════*/
+    class ZipfianGenerator
+    {
+    public:
+        ZipfianGenerator(size_t items, double theta) : n(std::max<size_t>(1, items)), theta(theta)
+        {
+            assert(theta > 0.0 && theta < 1.0 && "zipfian theta must be in (0, 1)");
+            for (size_t i = 1; i <= n; i++)
+                zetan += 1.0 / std::pow(static_cast<double>(i), theta);
+            double zeta2 = 1.0 + 1.0 / std::pow(2.0, theta);
+            alpha = 1.0 / (1.0 - theta);
+            eta = (1.0 - std::pow(2.0 / double(n), 1.0 - theta)) / (1.0 - zeta2 / zetan);
+            half_pow_theta = std::pow(0.5, theta);
+        }
+
+        // Rank in [0, items); 0 is the most popular. u uniform in [0, 1)
+        size_t rank(double u) const
+        {
+            double uz = u * zetan;
+            size_t r;
+            if (uz < 1.0) r = 0;
+            else if (uz < 1.0 + half_pow_theta) r = 1;
+            else r = static_cast<size_t>(double(n) * std::pow(eta * u - eta + 1.0, alpha));
+            return std::min(r, n - 1);
+        }
+
+        size_t items() const { return n; }
+
+    private:
+        size_t n;
+        double theta;
+        double zetan = 0.0, alpha = 0.0, eta = 0.0, half_pow_theta = 0.0;
+    };
+
+    // Zipf rank → key: scatters popular ranks over [0, range)
+    inline size_t scatter_rank(size_t rank, size_t range)
+    {
+        return static_cast<size_t>((rank * 0x9E3779B97F4A7C15ull >> 16) % range);
+    }
+
+    /*═══════════════════════════════════════════════════════════════════════════
+     * KeyChooser - Per-Thread Key Source for One Distribution
+     *═══════════════════════════════════════════════════════════════════════════
+     * next(records) returns a record index in [0, records). records is the
+     * current record count (it grows under inserts); ZIPFIAN / LATEST draw
+     * ranks over the count the shared ZipfianGenerator was built for.
+     * ZIPFIAN scatters ranks over that fixed item count too, so a rank maps
+     * to the same key for the whole run however many records are inserted;
+     * a key not (yet) below records is redrawn, as in YCSB's scrambled
+     * zipfian.
+     *═══════════════════════════════════════════════════════════════════════════*/
+    class KeyChooser
+    {
+    public:
+        KeyChooser(KeyDistribution dist, const ZipfianGenerator *zipf, uint64_t seed,
+                   double hot_fraction = 0.2, double hot_ops = 0.8)
+            : dist(dist), zipf(zipf), gen(seed), hot_fraction(hot_fraction), hot_ops(hot_ops)
+        {
+            assert((zipf || (dist != KeyDistribution::ZIPFIAN && dist != KeyDistribution::LATEST)) &&
+                   "ZIPFIAN / LATEST need a ZipfianGenerator");
+            sequential_next = static_cast<size_t>(seed);   // Threads start at different keys
+        }
+
+        size_t next(size_t records)
+        {
+            records = std::max<size_t>(1, records);
+            switch (dist)
+            {
+            case KeyDistribution::ZIPFIAN:
+                for (int attempt = 0;; ++attempt)
+                {
+                    size_t key = scatter_rank(zipf->rank(uniform()), zipf->items());
+                    if (key < records) return key;
+                    if (attempt == 16) return key % records;   // records far below items
+                }
+            case KeyDistribution::HOTSPOT:
+            {
+                size_t hot = std::max<size_t>(1, static_cast<size_t>(double(records) * hot_fraction));
+                if (hot >= records || uniform() < hot_ops)
+                    return below(hot);
+                return hot + below(records - hot);
+            }
+            case KeyDistribution::LATEST:
+                return records - 1 - std::min(zipf->rank(uniform()), records - 1);
+            case KeyDistribution::SEQUENTIAL:
+                return sequential_next++ % records;
+            case KeyDistribution::UNIFORM:
+            default:
+                return below(records);
+            }
+        }
+
+        double uniform() { return std::uniform_real_distribution<double>(0.0, 1.0)(gen); }
+        size_t below(size_t n) { return std::uniform_int_distribution<size_t>(0, n - 1)(gen); }
+        std::mt19937_64 &engine() { return gen; }
+
+    private:
+        KeyDistribution dist;
+        const ZipfianGenerator *zipf;
+        std::mt19937_64 gen;
+        double hot_fraction;
+        double hot_ops;
+        size_t sequential_next = 0;
+    };
+
+    /*═══════════════════════════════════════════════════════════════════════════
+     * YcsbWorkload - Operation Mix Presets A-F
+     *═══════════════════════════════════════════════════════════════════════════*/
+    enum class YcsbOp
+    {
+        READ,
+        UPDATE,
+        INSERT,
+        SCAN,
+        READ_MODIFY_WRITE,
+        COUNT
+    };
+
+    inline const char *ycsb_op_name(YcsbOp op)
+    {
+        static const char *const names[] = {"read", "update", "insert", "scan", "rmw"};
+        return names[static_cast<size_t>(op)];
+    }
+
+    struct YcsbWorkload
+    {
+        char name = 'A';
+        const char *description = "";
+        double proportion[static_cast<size_t>(YcsbOp::COUNT)] = {};   // Sums to 1
+        KeyDistribution distribution = KeyDistribution::ZIPFIAN;
+        size_t max_scan_length = 100;       // Scan lengths uniform in [1, max]
+
+        // Core workload 'A'..'F' (case-insensitive)
+        static YcsbWorkload preset(char letter)
+        {
+            YcsbWorkload w;
+            w.name = static_cast<char>(std::toupper(static_cast<unsigned char>(letter)));
+            auto mix = [&w](double read, double update, double insert, double scan, double rmw)
+            {
+                w.proportion[0] = read;
+                w.proportion[1] = update;
+                w.proportion[2] = insert;
+                w.proportion[3] = scan;
+                w.proportion[4] = rmw;
+            };
+            switch (w.name)
+            {
+            case 'A': w.description = "update heavy";      mix(0.50, 0.50, 0.00, 0.00, 0.00); break;
+            case 'B': w.description = "read mostly";       mix(0.95, 0.05, 0.00, 0.00, 0.00); break;
+            case 'C': w.description = "read only";         mix(1.00, 0.00, 0.00, 0.00, 0.00); break;
+            case 'D': w.description = "read latest";       mix(0.95, 0.00, 0.05, 0.00, 0.00);
+                      w.distribution = KeyDistribution::LATEST; break;
+            case 'E': w.description = "short ranges";      mix(0.00, 0.00, 0.05, 0.95, 0.00); break;
+            case 'F': w.description = "read-modify-write"; mix(0.50, 0.00, 0.00, 0.00, 0.50); break;
+            default: throw std::invalid_argument("YCSB workload must be one of A-F");
+            }
+            return w;
+        }
+
+        YcsbOp pick(double u) const
+        {
+            for (size_t i = 0; i + 1 < static_cast<size_t>(YcsbOp::COUNT); ++i)
+            {
+                if (u < proportion[i])
+                    return static_cast<YcsbOp>(i);
+                u -= proportion[i];
+            }
+            return YcsbOp::READ_MODIFY_WRITE;
+        }
+    };
+
+    /*═══════════════════════════════════════════════════════════════════════════
+     * run_ycsb - Drive One Workload Against a Loaded Tree
+     *═══════════════════════════════════════════════════════════════════════════
+     * The tree must hold keys [0, records). `threads` clients run the mix
+     * for `duration`; inserts append keys records, records+1, ... Keys are
+     * chosen below the acknowledged count, which only covers inserts that
+     * have completed (YCSB's AcknowledgedCounterGenerator), so reads never
+     * target a claimed key that is not in the tree yet. Scans walk
+     * ceiling() / successor() and need an engine with ordered navigation
+     * (RBTree); on other engines scans are skipped and counted in
+     * `unsupported`. Values are plain ints; reads and scans only feed
+     * YcsbResult::checksum.
+     *═══════════════════════════════════════════════════════════════════════════*/
+    struct YcsbResult
+    {
+        uint64_t ops[static_cast<size_t>(YcsbOp::COUNT)] = {};
+        uint64_t read_hits = 0;
+        uint64_t scanned = 0;               // Entries returned by scans
+        uint64_t unsupported = 0;           // Scans on engines without successor()
+        uint64_t checksum = 0;              // Sum of values read (keeps reads observable)
+        size_t records = 0;                 // Records after the run (keys [0, records))
+        double seconds = 0.0;
+
+        uint64_t total() const
+        {
+            uint64_t t = 0;
+            for (uint64_t n : ops) t += n;
+            return t;
+        }
+        double ops_per_sec() const { return seconds > 0.0 ? double(total()) / seconds : 0.0; }
+    };
+
+    template <typename Tree, typename = void>
+    struct has_ordered_scan : std::false_type {};
+    template <typename Tree>
+    struct has_ordered_scan<Tree, std::void_t<decltype(std::declval<const Tree &>().ceiling(0)),
+                                              decltype(std::declval<const Tree &>().successor(0))>>
+        : std::true_type {};
+
+    template <typename Tree>
+    YcsbResult run_ycsb(Tree &tree, const YcsbWorkload &w, size_t records, size_t threads,
+                        std::chrono::milliseconds duration, double zipf_theta = 0.99, uint64_t seed = 1)
+    {
+        std::unique_ptr<ZipfianGenerator> zipf;
+        if (w.distribution == KeyDistribution::ZIPFIAN || w.distribution == KeyDistribution::LATEST)
+            zipf = std::make_unique<ZipfianGenerator>(records, zipf_theta);
+
+        std::atomic<size_t> inserted{records};      // Next record index to insert
+        std::atomic<size_t> acknowledged{records};  // Every key below this is in the tree
+        std::atomic<bool> stop{false};
+        std::vector<YcsbResult> per_thread(std::max<size_t>(1, threads));
+
+        // Counts accumulate in a client-local YcsbResult and are stored once at
+        // the end: adjacent per_thread slots would otherwise share cache lines
+        auto client = [&](size_t id)
+        {
+            YcsbResult r;
+            KeyChooser keys(w.distribution, zipf.get(), seed * 7919 + id);
+            uint64_t &sum = r.checksum;
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                YcsbOp op = w.pick(keys.uniform());
+                size_t count = acknowledged.load(std::memory_order_acquire);
+                int key = static_cast<int>(keys.next(count));
+                switch (op)
+                {
+                case YcsbOp::READ:
+                    if (auto v = tree.lookup(key)) { ++r.read_hits; sum += static_cast<uint64_t>(*v); }
+                    break;
+                case YcsbOp::UPDATE:
+                    tree.insert(key, static_cast<int>(keys.below(1u << 30)));
+                    break;
+                case YcsbOp::INSERT:
+                {
+                    size_t next = inserted.fetch_add(1, std::memory_order_relaxed);
+                    tree.insert(static_cast<int>(next), static_cast<int>(next));
+                    // Acknowledge in claim order so the count never covers a gap
+                    while (acknowledged.load(std::memory_order_acquire) != next)
+                        std::this_thread::yield();
+                    acknowledged.store(next + 1, std::memory_order_release);
+                    break;
+                }
+                case YcsbOp::SCAN:
+                    if constexpr (has_ordered_scan<Tree>::value)
+                    {
+                        size_t len = 1 + keys.below(std::max<size_t>(1, w.max_scan_length));
+                        auto e = tree.ceiling(key);
+                        for (size_t i = 0; e && i < len; ++i)
+                        {
+                            sum += static_cast<uint64_t>(e->second);
+                            ++r.scanned;
+                            e = tree.successor(e->first);
+                        }
+                    }
+                    else
+                    {
+                        ++r.unsupported;
+                        continue;
+                    }
+                    break;
+                case YcsbOp::READ_MODIFY_WRITE:
+                {
+                    auto v = tree.lookup(key);
+                    tree.insert(key, v ? *v + 1 : 0);
+                    break;
+                }
+                default:
+                    break;
+                }
+                ++r.ops[static_cast<size_t>(op)];
+            }
+            per_thread[id] = r;
+        };
+
+        auto t0 = std::chrono::steady_clock::now();
+        std::vector<std::thread> pool;
+        for (size_t i = 1; i < per_thread.size(); ++i)
+            pool.emplace_back(client, i);
+        std::thread timer([&] { std::this_thread::sleep_for(duration); stop.store(true); });
+        client(0);
+        timer.join();
+        for (auto &t : pool)
+            t.join();
+
+        YcsbResult out;
+        out.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        for (const YcsbResult &r : per_thread)
+        {
+            for (size_t i = 0; i < static_cast<size_t>(YcsbOp::COUNT); ++i)
+                out.ops[i] += r.ops[i];
+            out.read_hits += r.read_hits;
+            out.scanned += r.scanned;
+            out.unsupported += r.unsupported;
+            out.checksum += r.checksum;
+        }
+        out.records = acknowledged.load();
+        return out;
+    }
+} // namespace rbt